@@ -0,0 +1,256 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "AgglomerativeClustering.h"
+#include <algorithm>
+
+void AgglomerativeClustering::setDistanceThreshold(float newValue)
+{
+    m_distanceThreshold = std::min(std::max(newValue, m_minThreshold), m_maxThreshold);
+}
+
+void AgglomerativeClustering::setMinDistanceThreshold(float newValue)
+{
+    m_minThreshold = newValue;
+}
+
+void AgglomerativeClustering::setMaxDistanceThreshold(float newValue)
+{
+    m_maxThreshold = newValue;
+}
+
+const ClusterResult& AgglomerativeClustering::getResult() const
+{
+    return m_result;
+}
+
+bool AgglomerativeClustering::fartherThan(const MergeCandidate& lhs, const MergeCandidate& rhs)
+{
+    if (lhs.distanceSq != rhs.distanceSq) return lhs.distanceSq > rhs.distanceSq;
+    const AkUInt32 lhsLow = std::min(lhs.a, lhs.b);
+    const AkUInt32 rhsLow = std::min(rhs.a, rhs.b);
+    if (lhsLow != rhsLow) return lhsLow > rhsLow;
+    return std::max(lhs.a, lhs.b) > std::max(rhs.a, rhs.b);
+}
+
+void AgglomerativeClustering::pushNearest(AkUInt32 cluster)
+{
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
+    const AkVector& centroid = m_centroids[cluster];
+    const SpatialGrid::Cell& center = m_cells[cluster];
+
+    MergeCandidate nearest{ thresholdSq, cluster, SpatialGrid::kNoObject, 0, 0 };
+    for (AkInt32 dz = -1; dz <= 1; ++dz) {
+        for (AkInt32 dy = -1; dy <= 1; ++dy) {
+            for (AkInt32 dx = -1; dx <= 1; ++dx) {
+                const SpatialGrid::Cell cell{ center.x + dx, center.y + dy, center.z + dz };
+                AkUInt32 other = m_bucketHeads[SpatialGrid::hashCell(cell) & m_bucketMask];
+                for (; other != SpatialGrid::kNoObject; other = m_cellNext[other]) {
+                    if (other == cluster || !(m_cells[other] == cell)) continue;
+
+                    const MergeCandidate candidate{ m_utilities.GetDistanceSquared(centroid, m_centroids[other]), cluster, other, 0, 0 };
+                    if (candidate.distanceSq > thresholdSq) continue;
+                    if (nearest.b == SpatialGrid::kNoObject || fartherThan(nearest, candidate)) {
+                        nearest = candidate;
+                    }
+                }
+            }
+        }
+    }
+    if (nearest.b == SpatialGrid::kNoObject) return;
+
+    nearest.versionA = m_versions[cluster];
+    nearest.versionB = m_versions[nearest.b];
+    m_heap.push_back(nearest);
+    std::push_heap(m_heap.begin(), m_heap.end(), fartherThan);
+}
+
+void AgglomerativeClustering::merge(AkUInt32 a, AkUInt32 b)
+{
+    m_sums[a].X += m_sums[b].X;
+    m_sums[a].Y += m_sums[b].Y;
+    m_sums[a].Z += m_sums[b].Z;
+    m_counts[a] += m_counts[b];
+    m_counts[b] = 0;
+
+    const float invCount = 1.0f / static_cast<float>(m_counts[a]);
+    m_centroids[a] = AkVector{ m_sums[a].X * invCount, m_sums[a].Y * invCount, m_sums[a].Z * invCount };
+    m_parent[b] = a;
+    ++m_versions[a];
+    ++m_versions[b];
+
+    removeFromGrid(b);
+    removeAlive(b);
+
+    const SpatialGrid::Cell cell = m_grid.cellOf(m_centroids[a]);
+    if (!(cell == m_cells[a])) {
+        removeFromGrid(a);
+        m_cells[a] = cell;
+        insertIntoGrid(a);
+    }
+}
+
+void AgglomerativeClustering::insertIntoGrid(AkUInt32 cluster)
+{
+    AkUInt32& head = m_bucketHeads[SpatialGrid::hashCell(m_cells[cluster]) & m_bucketMask];
+    m_cellPrev[cluster] = SpatialGrid::kNoObject;
+    m_cellNext[cluster] = head;
+    if (head != SpatialGrid::kNoObject) {
+        m_cellPrev[head] = cluster;
+    }
+    head = cluster;
+}
+
+void AgglomerativeClustering::removeFromGrid(AkUInt32 cluster)
+{
+    const AkUInt32 prev = m_cellPrev[cluster];
+    const AkUInt32 next = m_cellNext[cluster];
+    if (prev != SpatialGrid::kNoObject) {
+        m_cellNext[prev] = next;
+    }
+    else {
+        m_bucketHeads[SpatialGrid::hashCell(m_cells[cluster]) & m_bucketMask] = next;
+    }
+    if (next != SpatialGrid::kNoObject) {
+        m_cellPrev[next] = prev;
+    }
+}
+
+void AgglomerativeClustering::removeAlive(AkUInt32 cluster)
+{
+    const AkUInt32 last = m_alive.back();
+    m_alive[m_alivePosition[cluster]] = last;
+    m_alivePosition[last] = m_alivePosition[cluster];
+    m_alive.pop_back();
+}
+
+AkUInt32 AgglomerativeClustering::findRoot(AkUInt32 index)
+{
+    AkUInt32 root = index;
+    while (m_parent[root] != root) {
+        root = m_parent[root];
+    }
+    while (m_parent[index] != root) {
+        const AkUInt32 next = m_parent[index];
+        m_parent[index] = root;
+        index = next;
+    }
+    return root;
+}
+
+void AgglomerativeClustering::cluster(const ObjectPosition* objects, AkUInt32 numObjects)
+{
+    m_points.assign(objects, numObjects);
+
+    m_sums.resize(numObjects);
+    m_centroids.resize(numObjects);
+    m_counts.assign(numObjects, 1);
+    m_versions.assign(numObjects, 0);
+    m_parent.resize(numObjects);
+    m_alive.resize(numObjects);
+    m_alivePosition.resize(numObjects);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_sums[i] = m_points.position(i);
+        m_centroids[i] = m_sums[i];
+        m_parent[i] = i;
+        m_alive[i] = i;
+        m_alivePosition[i] = i;
+    }
+
+    m_heap.clear();
+    if (numObjects > 1 && m_distanceThreshold > 0.0f) {
+        m_grid.build(m_points, m_distanceThreshold);
+
+        // Same bucket count as the grid: at least two buckets per object
+        AkUInt32 numBuckets = 1;
+        while (numBuckets < numObjects * 2) {
+            numBuckets <<= 1;
+        }
+        m_bucketMask = numBuckets - 1;
+        m_bucketHeads.assign(numBuckets, SpatialGrid::kNoObject);
+        m_cells.resize(numObjects);
+        m_cellNext.resize(numObjects);
+        m_cellPrev.resize(numObjects);
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            m_cells[i] = m_grid.cellOfPoint(i);
+            insertIntoGrid(i);
+        }
+
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            pushNearest(i);
+        }
+    }
+
+    while (!m_heap.empty()) {
+        std::pop_heap(m_heap.begin(), m_heap.end(), fartherThan);
+        const MergeCandidate candidate = m_heap.back();
+        m_heap.pop_back();
+
+        // The owner was merged since, and pushed a new entry if it is still alive
+        if (candidate.versionA != m_versions[candidate.a]) {
+            continue;
+        }
+
+        // The neighbour was merged since, so the owner has to search again
+        if (candidate.versionB != m_versions[candidate.b]) {
+            pushNearest(candidate.a);
+            continue;
+        }
+
+        const AkUInt32 a = std::min(candidate.a, candidate.b);
+        merge(a, std::max(candidate.a, candidate.b));
+        pushNearest(a);
+    }
+
+    fillResult();
+}
+
+void AgglomerativeClustering::fillResult()
+{
+    const AkUInt32 numObjects = m_points.size();
+
+    // Counting sort by root; scanning the objects in order keeps each cluster's members ascending
+    m_clusterOffsets.assign(numObjects + 1, 0);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        ++m_clusterOffsets[findRoot(i) + 1];
+    }
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_clusterOffsets[i + 1] += m_clusterOffsets[i];
+    }
+    m_members.resize(numObjects);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_members[m_clusterOffsets[m_parent[i]]++] = i;
+    }
+
+    // The fill moved each offset to the end of its root's members; walk the roots in ascending order
+    std::sort(m_alive.begin(), m_alive.end());
+    m_result.clear();
+    AkUInt32 begin = 0;
+    for (AkUInt32 root : m_alive) {
+        m_result.addCluster(m_nextClusterId++, m_centroids[root]);
+        for (AkUInt32 m = begin; m < m_clusterOffsets[root]; ++m) {
+            m_result.addMember(m_points.key(m_members[m]));
+        }
+        begin = m_clusterOffsets[root];
+    }
+    m_result.finalize();
+}
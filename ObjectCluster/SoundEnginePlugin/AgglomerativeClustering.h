@@ -0,0 +1,167 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "IClusteringEngine.h"
+#include "PositionBuffer.h"
+#include "SpatialGrid.h"
+#include "ClusterResult.h"
+#include "Utilities.h"
+
+/**
+ * @brief Bottom-up clustering: repeatedly merges the two closest clusters.
+ *
+ * Every object starts as a cluster of its own. The pair of clusters whose centroids
+ * are closest is merged into one cluster at their combined centroid, and merging
+ * stops once no two centroids are within the distance threshold of each other. The
+ * result does not depend on any random choice, and no two of its centroids are
+ * closer than the threshold.
+ *
+ * Candidate merges are kept in a binary heap holding one entry per cluster: its
+ * nearest neighbour within the threshold, found through a grid of the live centroids
+ * with the threshold as its cell size, so only the 27 cells around a centroid are
+ * searched. After a merge only the merged cluster searches again. An entry whose
+ * owner changed since it was pushed is dropped when popped, and one whose neighbour
+ * changed makes its owner search again, so the heap never holds more than a few
+ * entries per object. For any two live clusters, the one that searched last already
+ * saw the other and pushed a pair at least as close, so a valid entry on top of the
+ * heap is always the closest pair; the merges are the same as comparing every pair.
+ *
+ * Each search costs the number of clusters around the centroid. With the clusters
+ * spread over many cells the whole run is close to linear in the object count; when
+ * most objects crowd within a few cells of each other it degrades towards quadratic
+ * time, though never more than linear memory.
+ */
+class AgglomerativeClustering : public IClusteringEngine {
+public:
+    /**
+     * @brief Sets the distance threshold.
+     * @param newValue The largest centroid distance at which two clusters are still merged.
+     */
+    void setDistanceThreshold(float newValue) override;
+
+    /**
+     * @brief Sets the lowest value the distance threshold is clamped to.
+     */
+    void setMinDistanceThreshold(float newValue);
+
+    /**
+     * @brief Sets the highest value the distance threshold is clamped to.
+     */
+    void setMaxDistanceThreshold(float newValue);
+
+    /**
+     * @brief Clusters the given objects, replacing the previous result.
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     */
+    void cluster(const ObjectPosition* objects, AkUInt32 numObjects) override;
+
+    /**
+     * @brief Gets the clusters of the last run, ordered by their lowest object index.
+     * @return The clusters, valid until the next call to cluster().
+     */
+    const ClusterResult& getResult() const override;
+
+private:
+    /**
+     * @brief Nearest neighbour b of cluster a, valid while both keep their version.
+     */
+    struct MergeCandidate {
+        float distanceSq;
+        AkUInt32 a;
+        AkUInt32 b;
+        AkUInt32 versionA;
+        AkUInt32 versionB;
+    };
+
+    /**
+     * @brief Orders the heap so the closest pair is on top, ties broken by the lower then the higher cluster index.
+     */
+    static bool fartherThan(const MergeCandidate& lhs, const MergeCandidate& rhs);
+
+    /**
+     * @brief Pushes the nearest neighbour of a cluster, if any is within the threshold.
+     */
+    void pushNearest(AkUInt32 cluster);
+
+    /**
+     * @brief Merges cluster b into cluster a, the lower index of the two.
+     */
+    void merge(AkUInt32 a, AkUInt32 b);
+
+    /**
+     * @brief Adds a live cluster to the bucket of the cell its centroid is in.
+     */
+    void insertIntoGrid(AkUInt32 cluster);
+
+    /**
+     * @brief Removes a cluster from its bucket.
+     */
+    void removeFromGrid(AkUInt32 cluster);
+
+    /**
+     * @brief Removes a cluster from m_alive by moving the last one into its place.
+     */
+    void removeAlive(AkUInt32 cluster);
+
+    /**
+     * @brief Finds the cluster an object was finally merged into, compressing the path.
+     */
+    AkUInt32 findRoot(AkUInt32 index);
+
+    /**
+     * @brief Refills m_result from the merged clusters.
+     */
+    void fillResult();
+
+    float m_distanceThreshold = 200.0f; ///< Largest centroid distance at which clusters are merged.
+    float m_minThreshold = 10.0f; ///< Lowest value for the distance threshold.
+    float m_maxThreshold = 1000.0f; ///< Highest value for the distance threshold.
+    PositionBuffer m_points; ///< SoA copy of the objects being clustered.
+    SpatialGrid m_grid; ///< Grid over m_points with the threshold as cell size, gives the cells of objects and centroids.
+
+    // Per cluster, indexed by the object it started from. A merged cluster lives on at the lower index.
+    std::vector<AkVector> m_sums; ///< Sum of the member positions.
+    std::vector<AkVector> m_centroids; ///< Mean of the member positions.
+    std::vector<AkUInt32> m_counts; ///< Number of members, 0 once merged into another cluster.
+    std::vector<AkUInt32> m_versions; ///< Incremented on every merge, invalidates older heap entries.
+    std::vector<AkUInt32> m_parent; ///< Cluster this one was merged into, itself while alive.
+    std::vector<AkUInt32> m_alivePosition; ///< Position in m_alive while alive.
+    std::vector<SpatialGrid::Cell> m_cells; ///< Cell of the centroid.
+    std::vector<AkUInt32> m_cellNext; ///< Next cluster in the same bucket, or SpatialGrid::kNoObject.
+    std::vector<AkUInt32> m_cellPrev; ///< Previous cluster in the same bucket, or SpatialGrid::kNoObject.
+
+    std::vector<AkUInt32> m_alive; ///< Indices of the clusters still alive, in no particular order.
+    std::vector<AkUInt32> m_bucketHeads; ///< First live cluster of each bucket, or SpatialGrid::kNoObject.
+    AkUInt32 m_bucketMask = 0; ///< Bucket count minus one, the count is a power of two.
+
+    std::vector<MergeCandidate> m_heap; ///< Nearest neighbours, closest pair first.
+    std::vector<AkUInt32> m_clusterOffsets; ///< Scratch: start of each root's members in m_members.
+    std::vector<AkUInt32> m_members; ///< Scratch: object indices grouped by root.
+
+    AkUInt32 m_nextClusterId = 0; ///< Identifier given to the next cluster.
+    ClusterResult m_result; ///< Result of the last run, refilled in place.
+    Utilities m_utilities;
+};
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "AsyncClusterer.h"
+#include <algorithm>
+
+AsyncClusterer::AsyncClusterer(EngineFactory factory)
+    : m_factory(factory)
+    , m_task([](void* context, AkUInt32) { static_cast<AsyncClusterer*>(context)->runJob(); }, this)
+{
+}
+
+AsyncClusterer::~AsyncClusterer()
+{
+    if (m_pool) {
+        m_pool->detach(m_task);
+    }
+}
+
+bool AsyncClusterer::joinPool(unsigned int numThreads)
+{
+    return joinPool(m_pool ? m_pool : WorkerPool::acquireShared(), numThreads);
+}
+
+bool AsyncClusterer::joinPool(std::shared_ptr<WorkerPool> pool, unsigned int numThreads)
+{
+    if (m_pool) {
+        m_pool->reserveThreads(numThreads);
+        return true;
+    }
+
+    // Jobs only run on workers, so the pool needs at least one besides the audio thread
+    pool->reserveThreads(std::max(numThreads, 2u));
+    if (pool->threadCount() < 2) {
+        return false;
+    }
+    m_pool = std::move(pool);
+    return true;
+}
+
+bool AsyncClusterer::start()
+{
+    if (m_running) return true;
+    if (!m_pool && !joinPool(2)) return false;
+
+    m_pool->attach(m_task);
+    m_running = true;
+    return true;
+}
+
+void AsyncClusterer::stop()
+{
+    if (!m_running) return;
+
+    m_pool->requestDetach(m_task);
+    m_running = false;
+}
+
+void AsyncClusterer::reserveJobs(AkUInt32 numObjects)
+{
+    m_jobs.forEachSlot([numObjects](Job& job) { job.objects.reserve(numObjects); });
+}
+
+void AsyncClusterer::submitJob(WorkerPool::Clock::time_point deadline)
+{
+    m_jobs.publish();
+    m_pool->post(m_task, deadline);
+}
+
+void AsyncClusterer::runJob()
+{
+    if (!m_jobs.acquire()) return;
+
+    const Job& job = m_jobs.readBuffer();
+    if (!m_engine || m_engineType != job.engineType) {
+        m_engine = m_factory(job.engineType);
+        m_engineType = job.engineType;
+    }
+
+    m_engine->configure(job.settings);
+    m_engine->cluster(job.objects.data(), static_cast<AkUInt32>(job.objects.size()));
+
+    m_results.writeBuffer() = m_engine->getResult();
+    m_results.publish();
+}
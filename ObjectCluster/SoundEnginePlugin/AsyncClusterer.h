@@ -0,0 +1,159 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <memory>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "IClusteringEngine.h"
+#include "ClusterResult.h"
+#include "PositionBuffer.h"
+#include "TripleBuffer.h"
+#include "WorkerPool.h"
+
+/**
+ * @brief Runs a clustering engine in the background, off the audio thread.
+ *
+ * The audio thread fills a Job with the positions and settings of the frame and
+ * submits it. The job goes to the process-wide WorkerPool, which runs it on one of its
+ * workers: the worker picks up the latest job, clusters it and publishes a copy of the
+ * result. Jobs and results both travel through TripleBuffer, and submitting only sets
+ * the task's atomics in the pool, so the audio thread neither takes a lock nor waits
+ * for clustering. A job submitted while the previous one runs replaces any older
+ * pending one, and acquireResult() returns the newest finished result, usually the
+ * previous frame's.
+ *
+ * The clusterer only attaches its task to the pool between start() and stop(), so an
+ * instance that does not cluster in the background costs the pool nothing. Stopping
+ * never waits either: a job in progress finishes in the background, a worker
+ * unregisters the task afterwards, and only the destructor waits for it.
+ *
+ * The engine is created through the factory given at construction, and recreated
+ * whenever a job asks for another engine type. It only ever runs one job at a time.
+ */
+class AsyncClusterer {
+public:
+    /**
+     * @brief Everything the worker needs to cluster one frame.
+     */
+    struct Job {
+        std::vector<ObjectPosition> objects; ///< Objects to cluster.
+        AkInt32 engineType = 0; ///< Engine to cluster with, passed to the factory.
+        ClusteringSettings settings; ///< Settings applied to the engine before clustering.
+    };
+
+    /// Creates the engine for an engine type
+    using EngineFactory = std::unique_ptr<IClusteringEngine> (*)(AkInt32 engineType);
+
+    /**
+     * @param factory Creates the engine for a job's engine type.
+     */
+    explicit AsyncClusterer(EngineFactory factory);
+    ~AsyncClusterer();
+
+    AsyncClusterer(const AsyncClusterer&) = delete;
+    AsyncClusterer& operator=(const AsyncClusterer&) = delete;
+
+    /**
+     * @brief Joins the shared pool, making sure it has a worker to run the jobs.
+     *
+     * Creates threads if needed, so call it at initialization rather than on the audio thread.
+     * The pool is kept until destruction, but no task is attached to it before start().
+     * @param numThreads Threads to make sure the pool has; at least two, the audio thread and a worker.
+     * @return False if no worker thread could be created.
+     */
+    bool joinPool(unsigned int numThreads);
+
+    /**
+     * @brief Joins the given pool instead of the shared one, see joinPool(unsigned int).
+     *
+     * Once joined, the clusterer keeps its pool and this only reserves threads in it.
+     * @param pool The pool to run the jobs on.
+     * @param numThreads Threads to make sure the pool has; at least two, the audio thread and a worker.
+     * @return False if the pool has no worker and could not create one; the clusterer stays unjoined.
+     */
+    bool joinPool(std::shared_ptr<WorkerPool> pool, unsigned int numThreads);
+
+    /**
+     * @brief Starts taking jobs, joining the shared pool first if joinPool() was not called.
+     *
+     * Attaches the task to the pool, which takes the pool lock briefly; does nothing while running.
+     * @return False if no worker thread could be created.
+     */
+    bool start();
+
+    /**
+     * @brief Stops taking jobs and drops a job not started yet. Never waits.
+     *
+     * The clusterer keeps its reference to the pool, so start() can resume without creating
+     * threads. A result finished after stopping may still be delivered once started again.
+     */
+    void stop();
+
+    bool isRunning() const { return m_running; }
+
+    /**
+     * @brief Reserves the storage of every job slot, so jobs of up to numObjects objects never allocate.
+     *
+     * Call it at initialization, before the first submitJob().
+     */
+    void reserveJobs(AkUInt32 numObjects);
+
+    /**
+     * @brief Gets the job to fill for the next submitJob(). Audio thread only.
+     */
+    Job& jobBuffer() { return m_jobs.writeBuffer(); }
+
+    /**
+     * @brief Hands the filled job to the pool. Audio thread only, never waits for clustering.
+     * @param deadline Time the result is needed by, normally the start of the next frame.
+     */
+    void submitJob(WorkerPool::Clock::time_point deadline);
+
+    /**
+     * @brief Takes the newest finished result, if a job finished since the last call. Audio thread only.
+     * @return True if result() changed.
+     */
+    bool acquireResult() { return m_results.acquire(); }
+
+    /**
+     * @brief Gets the result taken by the last acquireResult(), empty until the first one.
+     */
+    const ClusterResult& result() const { return m_results.readBuffer(); }
+
+private:
+    /**
+     * @brief Clusters the latest submitted job, on a pool worker.
+     */
+    void runJob();
+
+    EngineFactory m_factory;
+    std::unique_ptr<IClusteringEngine> m_engine; ///< Only used by runJob().
+    AkInt32 m_engineType = -1; ///< Type of m_engine.
+
+    TripleBuffer<Job> m_jobs; ///< Audio thread to worker.
+    TripleBuffer<ClusterResult> m_results; ///< Worker to audio thread.
+
+    std::shared_ptr<WorkerPool> m_pool; ///< Shared pool, once joined.
+    bool m_running = false; ///< Between start() and stop().
+    WorkerPool::PostedTask m_task; ///< Runs runJob() on the pool.
+};
@@ -0,0 +1,238 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+
+/*
+ * Standalone test of background clustering, not part of the plugin build.
+ * Runs on any platform with std::thread, without the sound engine:
+ * - A producer thread publishes frames through a TripleBuffer while a consumer
+ *   thread takes them, checking that no frame is torn and none goes backwards.
+ * - The main thread submits clustering jobs to an AsyncClusterer and takes the
+ *   results a pool worker publishes, checking each result belongs to one job.
+ * - A pool that cannot create a worker makes joinPool() fail, and clustering on
+ *   the calling thread instead gives the same result.
+ *
+ * Build it with the plugin sources other than ObjectClusterFX*.cpp and the Wwise SDK
+ * headers, for example:
+ *   g++ -std=c++17 -O2 -I$WWISESDK/include -x c++ AsyncClustererTest.h -x none
+ *       AsyncClusterer.cpp WorkerPool.cpp ... -lpthread
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "AsyncClusterer.h"
+#include "GridDensityClustering.h"
+#include "TripleBuffer.h"
+#include "WorkerPool.h"
+
+namespace {
+    constexpr AkUInt32 kKeysPerJob = 1000; ///< Keys of job n are n * kKeysPerJob and up.
+    constexpr AkUInt32 kObjectsPerBlob = 10;
+
+    /**
+     * @brief Frame for the TripleBuffer test: every value holds the sequence number.
+     */
+    struct Frame {
+        AkUInt32 sequence = 0;
+        AkUInt32 values[64] = {};
+        std::vector<AkUInt32> list; ///< Grows and shrinks, so slots reallocate while in use.
+    };
+
+    bool testTripleBuffer()
+    {
+        const AkUInt32 numFrames = 200000;
+        TripleBuffer<Frame> buffer;
+        bool ok = true;
+        AkUInt32 received = 0;
+
+        std::thread producer([&] {
+            for (AkUInt32 sequence = 1; sequence <= numFrames; ++sequence) {
+                Frame& frame = buffer.writeBuffer();
+                frame.sequence = sequence;
+                for (AkUInt32& value : frame.values) {
+                    value = sequence;
+                }
+                frame.list.assign(sequence % 97, sequence);
+                buffer.publish();
+
+                // Lets the consumer in even on a single core
+                std::this_thread::yield();
+            }
+        });
+
+        std::thread consumer([&] {
+            AkUInt32 last = 0;
+            while (last != numFrames) {
+                if (!buffer.acquire()) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const Frame& frame = buffer.readBuffer();
+                bool intact = frame.sequence > last && frame.list.size() == frame.sequence % 97;
+                for (AkUInt32 value : frame.values) {
+                    intact = intact && value == frame.sequence;
+                }
+                for (AkUInt32 value : frame.list) {
+                    intact = intact && value == frame.sequence;
+                }
+                if (!intact) {
+                    std::cout << "TripleBuffer: frame " << frame.sequence << " torn or out of order after " << last << "\n";
+                    ok = false;
+                    return;
+                }
+                last = frame.sequence;
+                ++received;
+            }
+        });
+
+        producer.join();
+        consumer.join();
+        std::cout << "TripleBuffer: " << received << " of " << numFrames << " frames received intact\n";
+        return ok;
+    }
+
+    std::unique_ptr<IClusteringEngine> createEngine(AkInt32)
+    {
+        return std::make_unique<GridDensityClustering>();
+    }
+
+    /**
+     * @brief Fills a job with 1 to 4 blobs far apart, so it clusters into exactly that many clusters.
+     */
+    void fillJob(AsyncClusterer::Job& job, AkUInt32 jobIndex)
+    {
+        const AkUInt32 numBlobs = 1 + jobIndex % 4;
+        job.objects.clear();
+        for (AkUInt32 blob = 0; blob < numBlobs; ++blob) {
+            for (AkUInt32 i = 0; i < kObjectsPerBlob; ++i) {
+                const AkVector position{ blob * 5000.0f + i * 10.0f, static_cast<float>(jobIndex % 7), 0.0f };
+                job.objects.push_back({ position, jobIndex * kKeysPerJob + blob * kObjectsPerBlob + i });
+            }
+        }
+        job.engineType = 0;
+        job.settings = ClusteringSettings();
+        job.settings.distanceThreshold = 200.0f;
+    }
+
+    /**
+     * @brief Checks that a result is the clustering of a single job, and returns that job.
+     * @return The job index, or -1 if the result mixes jobs or has the wrong clusters.
+     */
+    int jobOfResult(const ClusterResult& result)
+    {
+        if (result.size() == 0) return -1;
+
+        const AkUInt32 jobIndex = result[0].members[0] / kKeysPerJob;
+        if (result.size() != 1 + jobIndex % 4) return -1;
+
+        for (const ClusterView& cluster : result) {
+            if (cluster.members.size() != kObjectsPerBlob) return -1;
+            for (AkUInt32 m = 0; m < cluster.members.size(); ++m) {
+                if (cluster.members[m] / kKeysPerJob != jobIndex) return -1;
+            }
+        }
+        return static_cast<int>(jobIndex);
+    }
+
+    bool testAsyncClusterer()
+    {
+        const AkUInt32 numJobs = 2000;
+        AsyncClusterer clusterer(&createEngine);
+        if (!clusterer.joinPool(2) || !clusterer.start()) {
+            std::cout << "AsyncClusterer: could not join the pool\n";
+            return false;
+        }
+
+        bool ok = true;
+        int lastJob = -1;
+        AkUInt32 numResults = 0;
+        const auto takeResult = [&] {
+            if (!clusterer.acquireResult()) return;
+
+            const int job = jobOfResult(clusterer.result());
+            if (job < 0 || job < lastJob) {
+                std::cout << "AsyncClusterer: result of job " << job << " torn or out of order after " << lastJob << "\n";
+                ok = false;
+            }
+            lastJob = job;
+            ++numResults;
+        };
+
+        // Jobs come faster than they are clustered, so most of them replace a pending one
+        for (AkUInt32 jobIndex = 1; jobIndex <= numJobs && ok; ++jobIndex) {
+            fillJob(clusterer.jobBuffer(), jobIndex);
+            clusterer.submitJob(WorkerPool::Clock::now() + std::chrono::milliseconds(1));
+            takeResult();
+            if (jobIndex % 16 == 0) {
+                std::this_thread::sleep_for(std::chrono::microseconds(200));
+            }
+        }
+
+        // The last job is never dropped, only replaced by newer ones
+        const auto giveUp = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (ok && lastJob != static_cast<int>(numJobs) && std::chrono::steady_clock::now() < giveUp) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            takeResult();
+        }
+        if (lastJob != static_cast<int>(numJobs)) {
+            std::cout << "AsyncClusterer: last result is from job " << lastJob << ", not " << numJobs << "\n";
+            ok = false;
+        }
+
+        clusterer.stop();
+        std::cout << "AsyncClusterer: " << numResults << " results for " << numJobs << " jobs\n";
+        return ok;
+    }
+
+    bool testFallback()
+    {
+        // A pool limited to the calling thread can never offer a worker
+        AsyncClusterer clusterer(&createEngine);
+        if (clusterer.joinPool(std::make_shared<WorkerPool>(1), 2)) {
+            std::cout << "Fallback: joined a pool without workers\n";
+            return false;
+        }
+
+        // The plugin then clusters on the audio thread, with the same engine and job
+        AsyncClusterer::Job job;
+        fillJob(job, 3);
+        std::unique_ptr<IClusteringEngine> engine = createEngine(job.engineType);
+        engine->configure(job.settings);
+        engine->cluster(job.objects.data(), static_cast<AkUInt32>(job.objects.size()));
+
+        const bool ok = jobOfResult(engine->getResult()) == 3;
+        std::cout << "Fallback: " << (ok ? "synchronous result matches" : "synchronous result is wrong") << "\n";
+        return ok;
+    }
+}
+
+int main() {
+    bool ok = testTripleBuffer();
+    ok = testAsyncClusterer() && ok;
+    ok = testFallback() && ok;
+
+    std::cout << (ok ? "PASSED" : "FAILED") << "\n";
+    return ok ? 0 : 1;
+}
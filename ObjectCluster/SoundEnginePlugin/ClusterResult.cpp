@@ -0,0 +1,87 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "ClusterResult.h"
+#include <algorithm>
+
+ClusterResult::ClusterResult(const ClusterResult& other)
+{
+    *this = other;
+}
+
+ClusterResult& ClusterResult::operator=(const ClusterResult& other)
+{
+    if (this == &other) return *this;
+
+    // Vector assignment keeps the existing capacity, so refilling a warm copy doesn't allocate
+    m_clusters = other.m_clusters;
+    m_offsets = other.m_offsets;
+    m_memberIds = other.m_memberIds;
+    m_lookup = other.m_lookup;
+    bindSpans();
+    return *this;
+}
+
+void ClusterResult::clear()
+{
+    m_clusters.clear();
+    m_offsets.clear();
+    m_memberIds.clear();
+    m_lookup.clear();
+}
+
+void ClusterResult::addCluster(AkUInt32 id, const AkVector& centroid)
+{
+    m_clusters.push_back({ id, centroid, MemberSpan{} });
+    m_offsets.push_back(static_cast<AkUInt32>(m_memberIds.size()));
+}
+
+void ClusterResult::addMember(AkAudioObjectID key)
+{
+    m_lookup.push_back({ key, static_cast<AkUInt32>(m_clusters.size() - 1) });
+    m_memberIds.push_back(key);
+    m_clusters.back().members.count++;
+}
+
+void ClusterResult::finalize()
+{
+    bindSpans();
+    std::sort(m_lookup.begin(), m_lookup.end());
+}
+
+void ClusterResult::bindSpans()
+{
+    for (size_t c = 0; c < m_clusters.size(); ++c) {
+        m_clusters[c].members.data = m_memberIds.data() + m_offsets[c];
+    }
+}
+
+int ClusterResult::findCluster(AkAudioObjectID key) const
+{
+    auto it = std::lower_bound(m_lookup.begin(), m_lookup.end(), key,
+        [](const std::pair<AkAudioObjectID, AkUInt32>& entry, AkAudioObjectID value) { return entry.first < value; });
+
+    if (it == m_lookup.end() || it->first != key) {
+        return -1;
+    }
+    return static_cast<int>(it->second);
+}
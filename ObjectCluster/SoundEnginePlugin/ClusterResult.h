@@ -0,0 +1,127 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <utility>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/**
+ * @brief Read-only view of a contiguous run of object IDs.
+ */
+struct MemberSpan {
+    const AkAudioObjectID* data = nullptr;
+    AkUInt32 count = 0;
+
+    const AkAudioObjectID* begin() const { return data; }
+    const AkAudioObjectID* end() const { return data + count; }
+    AkUInt32 size() const { return count; }
+    bool empty() const { return count == 0; }
+    AkAudioObjectID operator[](AkUInt32 index) const { return data[index]; }
+};
+
+/**
+ * @brief One cluster of a ClusterResult.
+ */
+struct ClusterView {
+    AkUInt32 id; ///< Identifier of the cluster, kept across runs for as long as the clusterer can track it.
+    AkVector centroid; ///< Mean position of the members.
+    MemberSpan members; ///< Keys of the member objects.
+};
+
+/**
+ * @brief Flat clustering result: one ClusterView per cluster over a single member ID array.
+ *
+ * The clusterer refills the same instance every run, so once the storage has grown to
+ * the scene size no allocation happens, and readers walk it without copying. Cluster
+ * order is the clusterer's internal order, which does not depend on centroid values.
+ *
+ * Fill with clear(), then addCluster() followed by that cluster's addMember() calls,
+ * then finalize(). Views are only valid after finalize() and until the next clear().
+ */
+class ClusterResult {
+public:
+    ClusterResult() = default;
+
+    /**
+     * @brief Copies a finalized result; the copy's views point into its own storage.
+     */
+    ClusterResult(const ClusterResult& other);
+
+    /**
+     * @brief Copies a finalized result, reusing the storage already allocated here.
+     */
+    ClusterResult& operator=(const ClusterResult& other);
+
+    /**
+     * @brief Removes every cluster while keeping the allocated storage.
+     */
+    void clear();
+
+    /**
+     * @brief Starts a new cluster; following addMember() calls add to it.
+     * @param id The cluster identifier.
+     * @param centroid The cluster centroid.
+     */
+    void addCluster(AkUInt32 id, const AkVector& centroid);
+
+    /**
+     * @brief Adds an object to the cluster started last.
+     * @param key The object key.
+     */
+    void addMember(AkAudioObjectID key);
+
+    /**
+     * @brief Points the member spans at the final member storage and builds the key lookup.
+     */
+    void finalize();
+
+    /**
+     * @brief Gets the number of clusters.
+     */
+    size_t size() const { return m_clusters.size(); }
+
+    bool empty() const { return m_clusters.empty(); }
+
+    const ClusterView& operator[](size_t index) const { return m_clusters[index]; }
+
+    const ClusterView* begin() const { return m_clusters.data(); }
+    const ClusterView* end() const { return m_clusters.data() + m_clusters.size(); }
+
+    /**
+     * @brief Finds the cluster an object belongs to.
+     * @param key The object key.
+     * @return The index of the cluster, or -1 if the object is not in any cluster.
+     */
+    int findCluster(AkAudioObjectID key) const;
+
+private:
+    /**
+     * @brief Points the member spans at m_memberIds.
+     */
+    void bindSpans();
+
+    std::vector<ClusterView> m_clusters; ///< Cluster views; member spans are set by finalize().
+    std::vector<AkUInt32> m_offsets; ///< Per cluster: index of its first member in m_memberIds.
+    std::vector<AkAudioObjectID> m_memberIds; ///< Member keys of all clusters, grouped by cluster.
+    std::vector<std::pair<AkAudioObjectID, AkUInt32>> m_lookup; ///< (key, cluster index) sorted by key.
+};
@@ -0,0 +1,246 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+
+#include "ClusterTracker.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void ClusterTracker::update(const ClusterResult& clusters, float distanceScale)
+{
+    m_previousTracks.swap(m_tracks);
+    m_previousMembers.swap(m_members);
+
+    const size_t numClusters = clusters.size();
+    const size_t numPrevious = m_previousTracks.size();
+
+    m_tracks.resize(numClusters);
+    m_members.clear();
+    for (size_t c = 0; c < numClusters; ++c) {
+        m_tracks[c] = { 0, AK_INVALID_AUDIO_OBJECT_ID, clusters[c].centroid, clusters[c].members.size() };
+        for (AkAudioObjectID key : clusters[c].members) {
+            m_members.push_back({ key, static_cast<AkUInt32>(c) });
+        }
+    }
+    std::sort(m_members.begin(), m_members.end());
+
+    m_assignment.assign(numClusters, -1);
+    if (numClusters > 0 && numPrevious > 0) {
+        findCandidates(distanceScale);
+        if (std::max(numClusters, numPrevious) <= kExactAssignmentLimit) {
+            assignExactly(numClusters, numPrevious);
+        }
+        else {
+            assignGreedily(numPrevious);
+        }
+    }
+
+    for (size_t c = 0; c < numClusters; ++c) {
+        const int p = m_assignment[c];
+        if (p >= 0) {
+            m_tracks[c].id = m_previousTracks[p].id;
+            m_tracks[c].output = m_previousTracks[p].output;
+        }
+        else {
+            m_tracks[c].id = m_nextId++;
+        }
+    }
+}
+
+void ClusterTracker::clear()
+{
+    m_tracks.clear();
+    m_members.clear();
+}
+
+void ClusterTracker::findCandidates(float distanceScale)
+{
+    const size_t numClusters = m_tracks.size();
+    const size_t numPrevious = m_previousTracks.size();
+    auto pack = [](size_t cluster, size_t previous) { return (static_cast<AkUInt64>(cluster) << 32) | previous; };
+
+    // Both member lists are sorted by key, so one merge pass finds every shared member
+    m_sharedPairs.clear();
+    size_t previous = 0;
+    for (const auto& member : m_members) {
+        while (previous < m_previousMembers.size() && m_previousMembers[previous].first < member.first) {
+            ++previous;
+        }
+        if (previous < m_previousMembers.size() && m_previousMembers[previous].first == member.first) {
+            m_sharedPairs.push_back(pack(member.second, m_previousMembers[previous].second));
+        }
+    }
+    std::sort(m_sharedPairs.begin(), m_sharedPairs.end());
+
+    // Centroids closer than the scale are in neighbouring cells of a grid with the scale as cell size
+    m_nearPairs.clear();
+    if (distanceScale > 0.0f) {
+        m_previousCentroids.resize(static_cast<AkUInt32>(numPrevious));
+        for (size_t p = 0; p < numPrevious; ++p) {
+            m_previousCentroids.set(static_cast<AkUInt32>(p), m_previousTracks[p].centroid, 0);
+        }
+        m_grid.build(m_previousCentroids, distanceScale);
+
+        const float scaleSq = distanceScale * distanceScale;
+        for (size_t c = 0; c < numClusters; ++c) {
+            const AkVector centroid = m_tracks[c].centroid;
+            m_grid.forEachNeighbor(centroid, [&](AkUInt32 p) {
+                const AkVector other = m_previousCentroids.position(p);
+                const float dx = centroid.X - other.X;
+                const float dy = centroid.Y - other.Y;
+                const float dz = centroid.Z - other.Z;
+                if (dx * dx + dy * dy + dz * dz < scaleSq) {
+                    m_nearPairs.push_back(pack(c, p));
+                }
+            });
+        }
+        std::sort(m_nearPairs.begin(), m_nearPairs.end());
+    }
+
+    // Cost the union of both lists; a run of equal shared pairs is the shared member count
+    m_candidates.clear();
+    size_t shared = 0;
+    size_t near = 0;
+    while (shared < m_sharedPairs.size() || near < m_nearPairs.size()) {
+        const AkUInt64 pair = (near == m_nearPairs.size() || (shared < m_sharedPairs.size() && m_sharedPairs[shared] < m_nearPairs[near]))
+            ? m_sharedPairs[shared]
+            : m_nearPairs[near];
+
+        AkUInt32 sharedCount = 0;
+        while (shared < m_sharedPairs.size() && m_sharedPairs[shared] == pair) {
+            ++sharedCount;
+            ++shared;
+        }
+        if (near < m_nearPairs.size() && m_nearPairs[near] == pair) {
+            ++near;
+        }
+
+        const AkUInt32 c = static_cast<AkUInt32>(pair >> 32);
+        const AkUInt32 p = static_cast<AkUInt32>(pair);
+        const Track& current = m_tracks[c];
+        const Track& before = m_previousTracks[p];
+        const AkVector delta{ current.centroid.X - before.centroid.X, current.centroid.Y - before.centroid.Y, current.centroid.Z - before.centroid.Z };
+        const float distance = std::sqrt(delta.X * delta.X + delta.Y * delta.Y + delta.Z * delta.Z);
+        const float distanceCost = distanceScale > 0.0f ? std::min(distance / distanceScale, 1.0f) : (distance > 0.0f ? 1.0f : 0.0f);
+
+        const AkUInt32 combined = current.size + before.size - sharedCount;
+        const float overlap = combined > 0 ? static_cast<float>(sharedCount) / combined : 0.0f;
+
+        const float cost = 0.5f * distanceCost + 0.5f * (1.0f - overlap);
+        if (cost < kMaxMatchCost) {
+            m_candidates.push_back({ cost, c, p });
+        }
+    }
+}
+
+void ClusterTracker::assignExactly(size_t numClusters, size_t numPrevious)
+{
+    // Padding rows and columns cost as much as a rejected pair, so they soak up whatever stays unmatched
+    const size_t n = std::max(numClusters, numPrevious);
+    m_cost.assign(n * n, kMaxMatchCost);
+    for (const Candidate& candidate : m_candidates) {
+        m_cost[candidate.cluster * n + candidate.previous] = candidate.cost;
+    }
+    solveAssignment(n);
+
+    for (size_t column = 1; column <= numPrevious; ++column) {
+        const size_t c = static_cast<size_t>(m_columnRow[column] - 1);
+        if (c < numClusters && m_cost[c * n + column - 1] < kMaxMatchCost) {
+            m_assignment[c] = static_cast<int>(column - 1);
+        }
+    }
+}
+
+void ClusterTracker::assignGreedily(size_t numPrevious)
+{
+    // Ties go to the lower indices, so the outcome doesn't depend on the sort
+    std::sort(m_candidates.begin(), m_candidates.end(), [](const Candidate& a, const Candidate& b) {
+        if (a.cost != b.cost) return a.cost < b.cost;
+        if (a.cluster != b.cluster) return a.cluster < b.cluster;
+        return a.previous < b.previous;
+    });
+
+    m_previousUsed.assign(numPrevious, 0);
+    for (const Candidate& candidate : m_candidates) {
+        if (m_assignment[candidate.cluster] >= 0 || m_previousUsed[candidate.previous]) continue;
+
+        m_assignment[candidate.cluster] = static_cast<int>(candidate.previous);
+        m_previousUsed[candidate.previous] = 1;
+    }
+}
+
+void ClusterTracker::solveAssignment(size_t n)
+{
+    const float infinity = std::numeric_limits<float>::max();
+    m_rowPotential.assign(n + 1, 0.0f);
+    m_columnPotential.assign(n + 1, 0.0f);
+    m_columnRow.assign(n + 1, 0);
+    m_columnWay.assign(n + 1, 0);
+
+    // Adds the rows one at a time, each time growing the matching along a shortest augmenting path
+    for (size_t row = 1; row <= n; ++row) {
+        m_columnRow[0] = static_cast<int>(row);
+        size_t column = 0;
+        m_minSlack.assign(n + 1, infinity);
+        m_columnUsed.assign(n + 1, 0);
+
+        do {
+            m_columnUsed[column] = 1;
+            const int pathRow = m_columnRow[column];
+            float delta = infinity;
+            size_t nextColumn = 0;
+
+            for (size_t j = 1; j <= n; ++j) {
+                if (m_columnUsed[j]) continue;
+
+                const float slack = m_cost[(pathRow - 1) * n + (j - 1)] - m_rowPotential[pathRow] - m_columnPotential[j];
+                if (slack < m_minSlack[j]) {
+                    m_minSlack[j] = slack;
+                    m_columnWay[j] = static_cast<int>(column);
+                }
+                if (m_minSlack[j] < delta) {
+                    delta = m_minSlack[j];
+                    nextColumn = j;
+                }
+            }
+
+            for (size_t j = 0; j <= n; ++j) {
+                if (m_columnUsed[j]) {
+                    m_rowPotential[m_columnRow[j]] += delta;
+                    m_columnPotential[j] -= delta;
+                }
+                else {
+                    m_minSlack[j] -= delta;
+                }
+            }
+            column = nextColumn;
+        } while (m_columnRow[column] != 0);
+
+        // Flip the matching along the path
+        do {
+            const size_t previousColumn = static_cast<size_t>(m_columnWay[column]);
+            m_columnRow[column] = m_columnRow[previousColumn];
+            column = previousColumn;
+        } while (column != 0);
+    }
+}
@@ -0,0 +1,149 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+
+#pragma once
+#include <vector>
+#include <utility>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "ClusterResult.h"
+#include "PositionBuffer.h"
+#include "SpatialGrid.h"
+
+/**
+ * @brief Gives the clusters of successive results an identity that persists across runs.
+ *
+ * Engines number their clusters in whatever order suits them, and a cold start renumbers
+ * everything. The tracker matches each new result's clusters to the ones it tracked so
+ * far by minimum-cost assignment, the cost of a pair mixing the distance between the
+ * centroids with how few members they share. Matched clusters keep their track, with
+ * its persistent ID and output object; the others start new tracks.
+ *
+ * A pair sharing no member and with centroids a distance scale or more apart costs
+ * kMaxMatchCost and is never matched, so only the other pairs are costed: those sharing
+ * members, found by one merge of the key-sorted member lists, and those with centroids
+ * closer than the scale, found through a grid over the previous centroids. With N
+ * members, K clusters and E such candidate pairs, E is at most N plus the near pairs,
+ * which is O(K) unless centroids crowd within the scale of each other.
+ *
+ * Up to kExactAssignmentLimit clusters on either side, the Hungarian algorithm solves the
+ * assignment exactly, in O(K^3) on a matrix padded to the larger side. Above that a greedy
+ * pass takes the candidates from the cheapest up, in O(E log E). Both are exact when each
+ * cluster has at most one candidate, the usual case for clusters kept apart by the
+ * threshold. Overall an update costs O(N log N + E log E), plus the bounded O(K^3).
+ */
+class ClusterTracker {
+public:
+    /**
+     * @brief Matches a new result's clusters to the tracked ones. Call once per new result.
+     * @param clusters The new result; cluster indices of later calls refer to it.
+     * @param distanceScale Centroid distance at which a pair only matches through shared members, normally the distance threshold.
+     */
+    void update(const ClusterResult& clusters, float distanceScale);
+
+    /**
+     * @brief Forgets every track.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the persistent ID of a cluster of the last result.
+     */
+    AkUInt32 id(size_t cluster) const { return m_tracks[cluster].id; }
+
+    /**
+     * @brief Gets the output object tied to a cluster of the last result.
+     * @return The output key, or AK_INVALID_AUDIO_OBJECT_ID if none was set.
+     */
+    AkAudioObjectID output(size_t cluster) const { return m_tracks[cluster].output; }
+
+    /**
+     * @brief Ties an output object to a cluster of the last result, for as long as its track lasts.
+     */
+    void setOutput(size_t cluster, AkAudioObjectID key) { m_tracks[cluster].output = key; }
+
+private:
+    /// Pairs costing this much or more are not matched
+    static constexpr float kMaxMatchCost = 1.0f;
+
+    /// Most clusters on either side for which the assignment is solved exactly
+    static constexpr size_t kExactAssignmentLimit = 32;
+
+    /// Pair that may be matched, costing less than kMaxMatchCost
+    struct Candidate {
+        float cost;
+        AkUInt32 cluster;
+        AkUInt32 previous;
+    };
+
+    struct Track {
+        AkUInt32 id;
+        AkAudioObjectID output;
+        AkVector centroid;
+        AkUInt32 size;
+    };
+
+    /**
+     * @brief Fills m_candidates with the pairs that may be matched.
+     */
+    void findCandidates(float distanceScale);
+
+    /**
+     * @brief Matches the candidates exactly, through solveAssignment() on a dense matrix.
+     */
+    void assignExactly(size_t numClusters, size_t numPrevious);
+
+    /**
+     * @brief Matches the candidates greedily, cheapest first.
+     */
+    void assignGreedily(size_t numPrevious);
+
+    /**
+     * @brief Solves the assignment for the n x n matrix in m_cost.
+     *
+     * Fills m_columnRow with the row, from 1, assigned to each column, from 1.
+     */
+    void solveAssignment(size_t n);
+
+    std::vector<Track> m_tracks; ///< Per cluster of the last result.
+    std::vector<Track> m_previousTracks; ///< Scratch: tracks of the result before.
+    std::vector<std::pair<AkAudioObjectID, AkUInt32>> m_members; ///< (key, cluster) of the last result, sorted by key.
+    std::vector<std::pair<AkAudioObjectID, AkUInt32>> m_previousMembers; ///< Scratch: m_members of the result before.
+    std::vector<AkUInt64> m_sharedPairs; ///< Scratch: (cluster, previous) packed, once per shared member, sorted.
+    std::vector<AkUInt64> m_nearPairs; ///< Scratch: (cluster, previous) packed, for centroids within the scale, sorted.
+    PositionBuffer m_previousCentroids; ///< Scratch: centroids of the previous tracks, for m_grid.
+    SpatialGrid m_grid; ///< Scratch: grid over m_previousCentroids with the distance scale as cell size.
+    std::vector<Candidate> m_candidates; ///< Scratch: pairs that may be matched.
+    std::vector<int> m_assignment; ///< Scratch: previous track matched to each cluster, -1 if none.
+    std::vector<AkUInt8> m_previousUsed; ///< Scratch: 1 for each previous track already matched.
+    std::vector<float> m_cost; ///< Scratch: square cost matrix of assignExactly, row-major.
+
+    // Scratch of solveAssignment, 1-based as in the usual formulation
+    std::vector<float> m_rowPotential;
+    std::vector<float> m_columnPotential;
+    std::vector<float> m_minSlack;
+    std::vector<int> m_columnRow;
+    std::vector<int> m_columnWay;
+    std::vector<AkUInt8> m_columnUsed;
+
+    AkUInt32 m_nextId = 0;
+};
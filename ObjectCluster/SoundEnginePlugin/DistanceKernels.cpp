@@ -0,0 +1,254 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "DistanceKernels.h"
+#include <limits>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define OBJECTCLUSTER_SIMD_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OBJECTCLUSTER_SIMD_SSE2 1
+#endif
+
+namespace DistanceKernels {
+
+void findNearestCentroids(
+    const PositionBuffer& points,
+    const AkVector* centroids,
+    AkUInt32 numCentroids,
+    int* outNearest,
+    float* outDistanceSq,
+    float* outSecondDistanceSq,
+    AkUInt32 begin,
+    AkUInt32 end)
+{
+    const AkUInt32 last = end < points.paddedSize() ? end : points.paddedSize();
+    const float* px = points.x();
+    const float* py = points.y();
+    const float* pz = points.z();
+
+#if defined(OBJECTCLUSTER_SIMD_AVX)
+    for (AkUInt32 i = begin; i < last; i += 8) {
+        const __m256 x = _mm256_load_ps(px + i);
+        const __m256 y = _mm256_load_ps(py + i);
+        const __m256 z = _mm256_load_ps(pz + i);
+        __m256 best = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 second = best;
+        __m256 bestIndex = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+
+        for (AkUInt32 j = 0; j < numCentroids; ++j) {
+            const __m256 dx = _mm256_sub_ps(x, _mm256_set1_ps(centroids[j].X));
+            const __m256 dy = _mm256_sub_ps(y, _mm256_set1_ps(centroids[j].Y));
+            const __m256 dz = _mm256_sub_ps(z, _mm256_set1_ps(centroids[j].Z));
+            const __m256 distSq = _mm256_add_ps(
+                _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                _mm256_mul_ps(dz, dz));
+
+            // The runner-up is the smaller of the old runner-up and whichever of best/distSq loses
+            second = _mm256_min_ps(second, _mm256_max_ps(best, distSq));
+            const __m256 closer = _mm256_cmp_ps(distSq, best, _CMP_LT_OQ);
+            best = _mm256_blendv_ps(best, distSq, closer);
+            bestIndex = _mm256_blendv_ps(bestIndex, _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(j))), closer);
+        }
+
+        _mm256_storeu_ps(outDistanceSq + i, best);
+        if (outSecondDistanceSq) {
+            _mm256_storeu_ps(outSecondDistanceSq + i, second);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(outNearest + i), _mm256_castps_si256(bestIndex));
+    }
+#elif defined(OBJECTCLUSTER_SIMD_SSE2)
+    for (AkUInt32 i = begin; i < last; i += 4) {
+        const __m128 x = _mm_load_ps(px + i);
+        const __m128 y = _mm_load_ps(py + i);
+        const __m128 z = _mm_load_ps(pz + i);
+        __m128 best = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 second = best;
+        __m128 bestIndex = _mm_castsi128_ps(_mm_set1_epi32(-1));
+
+        for (AkUInt32 j = 0; j < numCentroids; ++j) {
+            const __m128 dx = _mm_sub_ps(x, _mm_set1_ps(centroids[j].X));
+            const __m128 dy = _mm_sub_ps(y, _mm_set1_ps(centroids[j].Y));
+            const __m128 dz = _mm_sub_ps(z, _mm_set1_ps(centroids[j].Z));
+            const __m128 distSq = _mm_add_ps(
+                _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+                _mm_mul_ps(dz, dz));
+
+            second = _mm_min_ps(second, _mm_max_ps(best, distSq));
+
+            // SSE2 has no blend instruction, select with and/andnot/or instead
+            const __m128 closer = _mm_cmplt_ps(distSq, best);
+            const __m128 index = _mm_castsi128_ps(_mm_set1_epi32(static_cast<int>(j)));
+            best = _mm_or_ps(_mm_and_ps(closer, distSq), _mm_andnot_ps(closer, best));
+            bestIndex = _mm_or_ps(_mm_and_ps(closer, index), _mm_andnot_ps(closer, bestIndex));
+        }
+
+        _mm_storeu_ps(outDistanceSq + i, best);
+        if (outSecondDistanceSq) {
+            _mm_storeu_ps(outSecondDistanceSq + i, second);
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(outNearest + i), _mm_castps_si128(bestIndex));
+    }
+#else
+    for (AkUInt32 i = begin; i < last; ++i) {
+        float best = std::numeric_limits<float>::max();
+        float second = best;
+        int bestIndex = -1;
+
+        for (AkUInt32 j = 0; j < numCentroids; ++j) {
+            const float dx = px[i] - centroids[j].X;
+            const float dy = py[i] - centroids[j].Y;
+            const float dz = pz[i] - centroids[j].Z;
+            const float distSq = dx * dx + dy * dy + dz * dz;
+            if (distSq < best) {
+                second = best;
+                best = distSq;
+                bestIndex = static_cast<int>(j);
+            }
+            else if (distSq < second) {
+                second = distSq;
+            }
+        }
+
+        outDistanceSq[i] = best;
+        outNearest[i] = bestIndex;
+        if (outSecondDistanceSq) {
+            outSecondDistanceSq[i] = second;
+        }
+    }
+#endif
+}
+
+int updateFarthestPoint(
+    const PositionBuffer& points,
+    const AkVector& centroid,
+    float* inOutMinDistanceSq,
+    float& outMaxDistanceSq)
+{
+    const AkUInt32 padded = points.paddedSize();
+    const float* px = points.x();
+    const float* py = points.y();
+    const float* pz = points.z();
+
+    float maxDistanceSq = -std::numeric_limits<float>::max();
+    int maxIndex = -1;
+
+#if defined(OBJECTCLUSTER_SIMD_AVX)
+    const __m256 cx = _mm256_set1_ps(centroid.X);
+    const __m256 cy = _mm256_set1_ps(centroid.Y);
+    const __m256 cz = _mm256_set1_ps(centroid.Z);
+    __m256 laneMax = _mm256_set1_ps(maxDistanceSq);
+    __m256i laneIndex = _mm256_set1_epi32(-1);
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256i step = _mm256_set1_epi32(8);
+
+    for (AkUInt32 i = 0; i < padded; i += 8) {
+        const __m256 dx = _mm256_sub_ps(_mm256_load_ps(px + i), cx);
+        const __m256 dy = _mm256_sub_ps(_mm256_load_ps(py + i), cy);
+        const __m256 dz = _mm256_sub_ps(_mm256_load_ps(pz + i), cz);
+        const __m256 distSq = _mm256_add_ps(
+            _mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+            _mm256_mul_ps(dz, dz));
+
+        const __m256 minDistSq = _mm256_min_ps(_mm256_loadu_ps(inOutMinDistanceSq + i), distSq);
+        _mm256_storeu_ps(inOutMinDistanceSq + i, minDistSq);
+
+        // Strict comparison keeps the first index of each lane's maximum
+        const __m256 greater = _mm256_cmp_ps(minDistSq, laneMax, _CMP_GT_OQ);
+        laneMax = _mm256_blendv_ps(laneMax, minDistSq, greater);
+        laneIndex = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(laneIndex), _mm256_castsi256_ps(index), greater));
+        index = _mm256_add_epi32(index, step);
+    }
+
+    alignas(32) float values[8];
+    alignas(32) int indices[8];
+    _mm256_store_ps(values, laneMax);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(indices), laneIndex);
+    for (int lane = 0; lane < 8; ++lane) {
+        if (indices[lane] < 0) continue;
+        if (values[lane] > maxDistanceSq || (values[lane] == maxDistanceSq && indices[lane] < maxIndex)) {
+            maxDistanceSq = values[lane];
+            maxIndex = indices[lane];
+        }
+    }
+#elif defined(OBJECTCLUSTER_SIMD_SSE2)
+    const __m128 cx = _mm_set1_ps(centroid.X);
+    const __m128 cy = _mm_set1_ps(centroid.Y);
+    const __m128 cz = _mm_set1_ps(centroid.Z);
+    __m128 laneMax = _mm_set1_ps(maxDistanceSq);
+    __m128 laneIndex = _mm_castsi128_ps(_mm_set1_epi32(-1));
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    const __m128i step = _mm_set1_epi32(4);
+
+    for (AkUInt32 i = 0; i < padded; i += 4) {
+        const __m128 dx = _mm_sub_ps(_mm_load_ps(px + i), cx);
+        const __m128 dy = _mm_sub_ps(_mm_load_ps(py + i), cy);
+        const __m128 dz = _mm_sub_ps(_mm_load_ps(pz + i), cz);
+        const __m128 distSq = _mm_add_ps(
+            _mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)),
+            _mm_mul_ps(dz, dz));
+
+        const __m128 minDistSq = _mm_min_ps(_mm_loadu_ps(inOutMinDistanceSq + i), distSq);
+        _mm_storeu_ps(inOutMinDistanceSq + i, minDistSq);
+
+        // Strict comparison keeps the first index of each lane's maximum
+        const __m128 greater = _mm_cmpgt_ps(minDistSq, laneMax);
+        laneMax = _mm_or_ps(_mm_and_ps(greater, minDistSq), _mm_andnot_ps(greater, laneMax));
+        laneIndex = _mm_or_ps(_mm_and_ps(greater, _mm_castsi128_ps(index)), _mm_andnot_ps(greater, laneIndex));
+        index = _mm_add_epi32(index, step);
+    }
+
+    alignas(16) float values[4];
+    alignas(16) int indices[4];
+    _mm_store_ps(values, laneMax);
+    _mm_store_si128(reinterpret_cast<__m128i*>(indices), _mm_castps_si128(laneIndex));
+    for (int lane = 0; lane < 4; ++lane) {
+        if (indices[lane] < 0) continue;
+        if (values[lane] > maxDistanceSq || (values[lane] == maxDistanceSq && indices[lane] < maxIndex)) {
+            maxDistanceSq = values[lane];
+            maxIndex = indices[lane];
+        }
+    }
+#else
+    for (AkUInt32 i = 0; i < padded; ++i) {
+        const float dx = px[i] - centroid.X;
+        const float dy = py[i] - centroid.Y;
+        const float dz = pz[i] - centroid.Z;
+        const float distSq = dx * dx + dy * dy + dz * dz;
+
+        if (distSq < inOutMinDistanceSq[i]) {
+            inOutMinDistanceSq[i] = distSq;
+        }
+        if (inOutMinDistanceSq[i] > maxDistanceSq) {
+            maxDistanceSq = inOutMinDistanceSq[i];
+            maxIndex = static_cast<int>(i);
+        }
+    }
+#endif
+
+    outMaxDistanceSq = maxDistanceSq;
+    return maxIndex;
+}
+
+}
@@ -0,0 +1,89 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "PositionBuffer.h"
+
+/**
+ * @brief Vectorized distance kernels operating on a PositionBuffer.
+ *
+ * Every kernel has an AVX path (eight objects per iteration), an SSE2 path (four
+ * objects per iteration) and a scalar fallback for platforms without either. The
+ * path is selected at compile time from the target architecture flags. All
+ * kernels work on squared distances so no square root is ever taken.
+ */
+namespace DistanceKernels {
+
+    /**
+     * @brief Finds the nearest centroid of every object in a position buffer.
+     *
+     * Ties are resolved towards the lowest centroid index, matching a sequential
+     * scan with a strict less-than comparison.
+     *
+     * @param points The object positions.
+     * @param centroids The centroids to search.
+     * @param numCentroids The number of centroids.
+     * @param outNearest Receives the nearest centroid index per object, or -1 when there
+     *        are no centroids. Must hold at least points.paddedSize() elements.
+     * @param outDistanceSq Receives the squared distance to the nearest centroid per object.
+     *        Must hold at least points.paddedSize() elements.
+     * @param outSecondDistanceSq Optionally receives the squared distance to the second
+     *        nearest centroid per object, as needed for the lower bounds of the KMeans
+     *        iteration. May be nullptr; otherwise must hold points.paddedSize() elements.
+     * @param begin First object to process, a multiple of 8. Only the objects in
+     *        [begin, end) are written, so disjoint ranges can run on different threads.
+     * @param end One past the last object to process, clamped to points.paddedSize().
+     */
+    void findNearestCentroids(
+        const PositionBuffer& points,
+        const AkVector* centroids,
+        AkUInt32 numCentroids,
+        int* outNearest,
+        float* outDistanceSq,
+        float* outSecondDistanceSq = nullptr,
+        AkUInt32 begin = 0,
+        AkUInt32 end = 0xFFFFFFFFu);
+
+    /**
+     * @brief Folds a new centroid into per-object minimum distances and finds the farthest object.
+     *
+     * This is the inner step of the farthest-point (k-means++) centroid selection:
+     * every object's running minimum squared distance is lowered to its distance to
+     * the new centroid if closer, and the object with the largest resulting minimum
+     * is returned in the same sweep.
+     *
+     * Padding slots of inOutMinDistanceSq must hold a negative value so they are
+     * never selected. Ties are resolved towards the lowest object index.
+     *
+     * @param points The object positions.
+     * @param centroid The newly added centroid.
+     * @param inOutMinDistanceSq Running minimum squared distance per object, points.paddedSize() elements.
+     * @param outMaxDistanceSq Receives the largest minimum squared distance.
+     * @return The index of the object with the largest minimum distance, -1 if the buffer is empty.
+     */
+    int updateFarthestPoint(
+        const PositionBuffer& points,
+        const AkVector& centroid,
+        float* inOutMinDistanceSq,
+        float& outMaxDistanceSq);
+}
@@ -0,0 +1,122 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "FrameArena.h"
+#include <algorithm>
+#include <cstdint>
+
+namespace {
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+FrameArena::~FrameArena()
+{
+    Term();
+}
+
+AKRESULT FrameArena::Init(AK::IAkPluginMemAlloc* in_pAllocator, size_t in_capacity)
+{
+    Term();
+    m_pAllocator = in_pAllocator;
+    m_pBlock = static_cast<char*>(m_pAllocator->Malloc(in_capacity, __FILE__, __LINE__));
+    if (!m_pBlock) {
+        return AK_InsufficientMemory;
+    }
+
+    m_capacity = in_capacity;
+    m_used = 0;
+    m_overflowUsed = 0;
+    return AK_Success;
+}
+
+void FrameArena::Term()
+{
+    if (!m_pAllocator) return;
+
+    for (void* block : m_overflowBlocks) {
+        m_pAllocator->Free(block);
+    }
+    m_overflowBlocks.clear();
+
+    if (m_pBlock) {
+        m_pAllocator->Free(m_pBlock);
+        m_pBlock = nullptr;
+    }
+    m_capacity = 0;
+    m_used = 0;
+    m_overflowUsed = 0;
+}
+
+void FrameArena::Reset()
+{
+    if (!m_overflowBlocks.empty()) {
+        const size_t highWater = m_used + m_overflowUsed;
+
+        for (void* block : m_overflowBlocks) {
+            m_pAllocator->Free(block);
+        }
+        m_overflowBlocks.clear();
+
+        // Grow with some headroom so a slowly growing scene doesn't overflow every frame
+        const size_t newCapacity = highWater + highWater / 2;
+        char* pNewBlock = static_cast<char*>(m_pAllocator->Malloc(newCapacity, __FILE__, __LINE__));
+        if (pNewBlock) {
+            if (m_pBlock) {
+                m_pAllocator->Free(m_pBlock);
+            }
+            m_pBlock = pNewBlock;
+            m_capacity = newCapacity;
+        }
+    }
+
+    m_used = 0;
+    m_overflowUsed = 0;
+}
+
+void* FrameArena::Alloc(size_t in_size, size_t in_alignment)
+{
+    if (m_pBlock) {
+        const uintptr_t base = reinterpret_cast<uintptr_t>(m_pBlock);
+        const size_t offset = alignUp(base + m_used, in_alignment) - base;
+        if (offset + in_size <= m_capacity) {
+            m_used = offset + in_size;
+            return m_pBlock + offset;
+        }
+    }
+
+    if (!m_pAllocator) return nullptr;
+
+    // The main block is full, serve this request from a dedicated block until the next reset
+    const size_t blockSize = in_size + in_alignment;
+    if (m_overflowBlocks.size() == m_overflowBlocks.capacity()) {
+        m_overflowBlocks.reserve(std::max<size_t>(8, m_overflowBlocks.capacity() * 2));
+    }
+    char* pBlock = static_cast<char*>(m_pAllocator->Malloc(blockSize, __FILE__, __LINE__));
+    if (!pBlock) return nullptr;
+
+    m_overflowBlocks.push_back(pBlock);
+    m_overflowUsed += blockSize;
+    return reinterpret_cast<void*>(alignUp(reinterpret_cast<uintptr_t>(pBlock), in_alignment));
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <vector>
+#include <AK/SoundEngine/Common/IAkPlugin.h>
+
+/**
+ * @class FrameArena
+ * @brief Bump allocator for data that only lives for one Execute call.
+ *
+ * The main block is allocated from the plugin allocator at Init and rewound by
+ * Reset() at the top of every Execute, so per-frame containers cost a pointer bump
+ * instead of a heap allocation. Requests that don't fit are served from overflow
+ * blocks, also taken from the plugin allocator; the next Reset() releases them and
+ * grows the main block to the observed high-water mark, so after a short warm-up
+ * the audio thread allocates nothing.
+ *
+ * Individual frees are no-ops. Nothing allocated from the arena may be used after
+ * the next Reset().
+ */
+class FrameArena {
+public:
+    FrameArena() = default;
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    /**
+     * @brief Allocates the main block.
+     * @param in_pAllocator The plugin allocator used for all blocks.
+     * @param in_capacity Initial size of the main block in bytes.
+     * @return AK_Success, or AK_InsufficientMemory if the block couldn't be allocated.
+     */
+    AKRESULT Init(AK::IAkPluginMemAlloc* in_pAllocator, size_t in_capacity);
+
+    /**
+     * @brief Releases every block.
+     */
+    void Term();
+
+    /**
+     * @brief Rewinds the arena, invalidating everything allocated since the last reset.
+     *
+     * If the previous frame overflowed, the overflow blocks are released and the main
+     * block is reallocated large enough for that frame.
+     */
+    void Reset();
+
+    /**
+     * @brief Allocates memory from the arena.
+     * @param in_size Size in bytes.
+     * @param in_alignment Required alignment, a power of two.
+     * @return The allocation, or nullptr if the plugin allocator is out of memory.
+     */
+    void* Alloc(size_t in_size, size_t in_alignment);
+
+    /**
+     * @brief Gets the number of bytes handed out since the last reset.
+     */
+    size_t BytesUsed() const { return m_used + m_overflowUsed; }
+
+private:
+    AK::IAkPluginMemAlloc* m_pAllocator = nullptr;
+    char* m_pBlock = nullptr; ///< Main block.
+    size_t m_capacity = 0; ///< Size of the main block.
+    size_t m_used = 0; ///< Bytes used in the main block, including alignment padding.
+    size_t m_overflowUsed = 0; ///< Bytes served from overflow blocks this frame.
+    std::vector<void*> m_overflowBlocks; ///< Blocks allocated because the main block was full.
+};
+
+/**
+ * @brief STL allocator drawing from a FrameArena.
+ *
+ * A default-constructed allocator has no arena and falls back to the global heap,
+ * so arena-backed container types can still be used outside of Execute.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+
+    ArenaAllocator() = default;
+    explicit ArenaAllocator(FrameArena* in_pArena) : m_pArena(in_pArena) {}
+
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : m_pArena(other.Arena()) {}
+
+    T* allocate(std::size_t count) {
+        if (m_pArena) {
+            void* p = m_pArena->Alloc(count * sizeof(T), alignof(T));
+            if (!p) throw std::bad_alloc();
+            return static_cast<T*>(p);
+        }
+        return static_cast<T*>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T* ptr, std::size_t) {
+        if (!m_pArena) {
+            ::operator delete(ptr);
+        }
+    }
+
+    FrameArena* Arena() const { return m_pArena; }
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return m_pArena == other.Arena(); }
+
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return m_pArena != other.Arena(); }
+
+private:
+    FrameArena* m_pArena = nullptr;
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
@@ -0,0 +1,250 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "GridDensityClustering.h"
+#include <algorithm>
+
+namespace {
+    // Gap between two intervals, 0 if they overlap
+    float gap(float minA, float maxA, float minB, float maxB)
+    {
+        return std::max(0.0f, std::max(minA - maxB, minB - maxA));
+    }
+
+    // Largest distance between a point of one interval and a point of the other
+    float span(float minA, float maxA, float minB, float maxB)
+    {
+        return std::max(maxA - minB, maxB - minA);
+    }
+}
+
+void GridDensityClustering::setDistanceThreshold(float newValue)
+{
+    m_distanceThreshold = newValue;
+}
+
+const ClusterResult& GridDensityClustering::getResult() const
+{
+    return m_result;
+}
+
+AkUInt32 GridDensityClustering::findRoot(AkUInt32 index)
+{
+    while (m_parent[index] != index) {
+        m_parent[index] = m_parent[m_parent[index]];
+        index = m_parent[index];
+    }
+    return index;
+}
+
+void GridDensityClustering::cluster(const ObjectPosition* objects, AkUInt32 numObjects)
+{
+    m_points.assign(objects, numObjects);
+
+    m_parent.resize(numObjects);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_parent[i] = i;
+    }
+
+    if (numObjects > 1 && m_distanceThreshold > 0.0f) {
+        m_grid.build(m_points, m_distanceThreshold * kInvSqrt3);
+        groupCells();
+        joinCells();
+    }
+
+    fillResult();
+}
+
+void GridDensityClustering::groupCells()
+{
+    const AkUInt32 numObjects = m_points.size();
+
+    // The lowest indexed object of a cell comes first in the object order, so it is
+    // always still a root when the others of its cell are joined to it
+    m_cellStart.assign(numObjects + 1, 0);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_parent[i] = m_grid.firstInCell(m_grid.cellOfPoint(i));
+        ++m_cellStart[m_parent[i] + 1];
+    }
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_cellStart[i + 1] += m_cellStart[i];
+    }
+
+    m_cellMembers.resize(numObjects);
+    m_cellCursor.assign(m_cellStart.begin(), m_cellStart.end() - 1);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_cellMembers[m_cellCursor[m_parent[i]]++] = i;
+    }
+
+    // Cells are only sorted once cellsTouch has to sweep them
+    m_cellSorted.assign(numObjects, 0);
+    m_cellBounds.resize(numObjects);
+    for (AkUInt32 cell = 0; cell < numObjects; ++cell) {
+        const AkUInt32 begin = m_cellStart[cell];
+        const AkUInt32 end = m_cellStart[cell + 1];
+        if (begin == end) continue;
+
+        Bounds& bounds = m_cellBounds[cell];
+        bounds.min = bounds.max = m_points.position(m_cellMembers[begin]);
+        for (AkUInt32 m = begin + 1; m < end; ++m) {
+            const AkVector p = m_points.position(m_cellMembers[m]);
+            bounds.min.X = std::min(bounds.min.X, p.X); bounds.max.X = std::max(bounds.max.X, p.X);
+            bounds.min.Y = std::min(bounds.min.Y, p.Y); bounds.max.Y = std::max(bounds.max.Y, p.Y);
+            bounds.min.Z = std::min(bounds.min.Z, p.Z); bounds.max.Z = std::max(bounds.max.Z, p.Z);
+        }
+    }
+}
+
+void GridDensityClustering::joinCells()
+{
+    const AkUInt32 numObjects = m_points.size();
+
+    for (AkUInt32 cell = 0; cell < numObjects; ++cell) {
+        if (m_cellStart[cell] == m_cellStart[cell + 1]) continue;
+
+        const SpatialGrid::Cell center = m_grid.cellOfPoint(cell);
+
+        // With a diagonal equal to the threshold, objects within it are at most two cells
+        // apart on each axis. Only the forward half of the offsets is visited, so each pair
+        // of cells is tested once.
+        for (AkInt32 dz = 0; dz <= 2; ++dz) {
+            for (AkInt32 dy = (dz == 0 ? 0 : -2); dy <= 2; ++dy) {
+                for (AkInt32 dx = (dz == 0 && dy == 0 ? 1 : -2); dx <= 2; ++dx) {
+                    const AkUInt32 other = m_grid.firstInCell(SpatialGrid::Cell{ center.x + dx, center.y + dy, center.z + dz });
+                    if (other == SpatialGrid::kNoObject) continue;
+
+                    AkUInt32 rootA = findRoot(cell);
+                    AkUInt32 rootB = findRoot(other);
+                    if (rootA == rootB) continue;
+
+                    if (cellsTouch(cell, other)) {
+                        // Keeping the lower index as root makes the cluster order independent of the grid
+                        if (rootB < rootA) std::swap(rootA, rootB);
+                        m_parent[rootB] = rootA;
+                    }
+                }
+            }
+        }
+    }
+}
+
+void GridDensityClustering::sortCell(AkUInt32 cell)
+{
+    if (m_cellSorted[cell]) return;
+
+    const float* x = m_points.x();
+    std::sort(m_cellMembers.begin() + m_cellStart[cell], m_cellMembers.begin() + m_cellStart[cell + 1],
+        [x](AkUInt32 a, AkUInt32 b) { return x[a] < x[b] || (x[a] == x[b] && a < b); });
+    m_cellSorted[cell] = 1;
+}
+
+bool GridDensityClustering::cellsTouch(AkUInt32 cellA, AkUInt32 cellB)
+{
+    const float threshold = m_distanceThreshold;
+    const float thresholdSq = threshold * threshold;
+    const Bounds& a = m_cellBounds[cellA];
+    const Bounds& b = m_cellBounds[cellB];
+
+    // The closest and farthest points of the two boxes settle most pairs of cells
+    const float gapX = gap(a.min.X, a.max.X, b.min.X, b.max.X);
+    const float gapY = gap(a.min.Y, a.max.Y, b.min.Y, b.max.Y);
+    const float gapZ = gap(a.min.Z, a.max.Z, b.min.Z, b.max.Z);
+    if (gapX * gapX + gapY * gapY + gapZ * gapZ > thresholdSq) {
+        return false;
+    }
+    const float spanX = span(a.min.X, a.max.X, b.min.X, b.max.X);
+    const float spanY = span(a.min.Y, a.max.Y, b.min.Y, b.max.Y);
+    const float spanZ = span(a.min.Z, a.max.Z, b.min.Z, b.max.Z);
+    if (spanX * spanX + spanY * spanY + spanZ * spanZ <= thresholdSq) {
+        return true;
+    }
+
+    // With both cells sorted along X, the objects of B within reach of an object of A
+    // on X form a window that only moves forward
+    sortCell(cellA);
+    sortCell(cellB);
+    const float* x = m_points.x();
+    const AkUInt32 endB = m_cellStart[cellB + 1];
+    AkUInt32 firstB = m_cellStart[cellB];
+    for (AkUInt32 i = m_cellStart[cellA]; i < m_cellStart[cellA + 1]; ++i) {
+        const AkVector position = m_points.position(m_cellMembers[i]);
+
+        // Objects that cannot reach B's box are skipped without scanning B
+        const float toX = gap(position.X, position.X, b.min.X, b.max.X);
+        const float toY = gap(position.Y, position.Y, b.min.Y, b.max.Y);
+        const float toZ = gap(position.Z, position.Z, b.min.Z, b.max.Z);
+        if (toX * toX + toY * toY + toZ * toZ > thresholdSq) continue;
+
+        while (firstB < endB && x[m_cellMembers[firstB]] < position.X - threshold) {
+            ++firstB;
+        }
+        for (AkUInt32 j = firstB; j < endB && x[m_cellMembers[j]] <= position.X + threshold; ++j) {
+            if (m_utilities.GetDistanceSquared(position, m_points.position(m_cellMembers[j])) <= thresholdSq) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void GridDensityClustering::fillResult()
+{
+    const AkUInt32 numObjects = m_points.size();
+
+    // Counting sort by root; scanning the objects in order keeps each cluster's members ascending
+    m_clusterOffsets.assign(numObjects + 1, 0);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_parent[i] = findRoot(i);
+        ++m_clusterOffsets[m_parent[i] + 1];
+    }
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_clusterOffsets[i + 1] += m_clusterOffsets[i];
+    }
+    m_members.resize(numObjects);
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        m_members[m_clusterOffsets[m_parent[i]]++] = i;
+    }
+
+    // The fill moved each offset to the end of its root's members, and a root is its set's first object
+    m_result.clear();
+    AkUInt32 begin = 0;
+    for (AkUInt32 root = 0; root < numObjects; ++root) {
+        if (m_parent[root] != root) continue;
+
+        const AkUInt32 end = m_clusterOffsets[root];
+        AkVector sum{ 0, 0, 0 };
+        for (AkUInt32 m = begin; m < end; ++m) {
+            const AkVector position = m_points.position(m_members[m]);
+            sum.X += position.X;
+            sum.Y += position.Y;
+            sum.Z += position.Z;
+        }
+        const float invCount = 1.0f / static_cast<float>(end - begin);
+
+        m_result.addCluster(m_nextClusterId++, AkVector{ sum.X * invCount, sum.Y * invCount, sum.Z * invCount });
+        for (AkUInt32 m = begin; m < end; ++m) {
+            m_result.addMember(m_points.key(m_members[m]));
+        }
+        begin = end;
+    }
+    m_result.finalize();
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "IClusteringEngine.h"
+#include "PositionBuffer.h"
+#include "SpatialGrid.h"
+#include "ClusterResult.h"
+#include "Utilities.h"
+
+/**
+ * @brief Single-pass density clustering: objects within the threshold of each other share a cluster.
+ *
+ * Objects are hashed into a grid whose cells have a diagonal equal to the distance
+ * threshold, so any two objects sharing a cell are within the threshold of each
+ * other and the whole cell joins one set of a union-find forest at once. Two occupied
+ * cells at most two cells apart are then joined when any object of one is within the
+ * threshold of any object of the other; the check stops at the first such pair, and
+ * is skipped altogether when the cells are already in the same set. The resulting
+ * connected components are the clusters.
+ *
+ * Each cell keeps the bounds of its objects, so most pairs of cells are settled from
+ * the bounds alone. For the others both cells are sorted along X, once per run, and
+ * only objects within the threshold of each other along X are compared.
+ *
+ * This is DBSCAN with a minimum of one point per neighbourhood: every object is a
+ * core object and nothing is treated as noise, isolated objects simply form clusters
+ * of their own. There is no iteration and no centroid search, so the cost grows with
+ * the object count and the number of occupied cells but not with the number of
+ * clusters. Clusters can chain: a line of objects spaced just under the threshold
+ * becomes one cluster however long it is, so members are not bounded to the
+ * threshold around the centroid.
+ */
+class GridDensityClustering : public IClusteringEngine {
+public:
+    /**
+     * @brief Sets the distance threshold.
+     * @param newValue The largest distance at which two objects are joined.
+     */
+    void setDistanceThreshold(float newValue) override;
+
+    /**
+     * @brief Clusters the given objects, replacing the previous result.
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     */
+    void cluster(const ObjectPosition* objects, AkUInt32 numObjects) override;
+
+    /**
+     * @brief Gets the clusters of the last run, ordered by their lowest object index.
+     * @return The clusters, valid until the next call to cluster().
+     */
+    const ClusterResult& getResult() const override;
+
+private:
+    /**
+     * @brief Finds the representative of an object's set, halving the path on the way.
+     */
+    AkUInt32 findRoot(AkUInt32 index);
+
+    /**
+     * @brief Joins every object to the lowest indexed object of its cell and groups the objects by cell.
+     */
+    void groupCells();
+
+    /**
+     * @brief Joins the sets of neighbouring cells that hold a pair of objects within the threshold.
+     */
+    void joinCells();
+
+    /**
+     * @brief Tests whether any object of one cell is within the threshold of any object of another.
+     *
+     * Cells whose bounds are farther apart than the threshold never touch, and cells whose
+     * bounds fit within it always do. Otherwise the objects of the first cell that can reach
+     * the second cell's bounds are swept against a window of the second cell's objects along
+     * X, stopping at the first pair within the threshold.
+     *
+     * @param cellA The lowest object index of the first cell.
+     * @param cellB The lowest object index of the second cell.
+     */
+    bool cellsTouch(AkUInt32 cellA, AkUInt32 cellB);
+
+    /**
+     * @brief Sorts the objects of a cell along X, unless that was already done this run.
+     * @param cell The lowest object index of the cell.
+     */
+    void sortCell(AkUInt32 cell);
+
+    /**
+     * @brief Refills m_result from the union-find forest.
+     */
+    void fillResult();
+
+    float m_distanceThreshold = 200.0f; ///< Largest distance at which objects are joined.
+    PositionBuffer m_points; ///< SoA copy of the objects being clustered.
+    SpatialGrid m_grid; ///< Grid over m_points with the threshold as cell diagonal.
+    std::vector<AkUInt32> m_parent; ///< Union-find forest; a root is the lowest object index of its set.
+
+    // Objects grouped by cell. A cell is identified by its lowest object index, and its
+    // objects are m_cellMembers[m_cellStart[first]] .. m_cellMembers[m_cellStart[first + 1] - 1].
+    std::vector<AkUInt32> m_cellStart; ///< Per object index, plus one: start of the cell it leads, empty otherwise.
+    std::vector<AkUInt32> m_cellMembers; ///< Object indices grouped by cell.
+    std::vector<AkUInt32> m_cellCursor; ///< Scratch: fill position per cell while building m_cellMembers.
+
+    /// Axis-aligned box around the objects of a cell
+    struct Bounds {
+        AkVector min;
+        AkVector max;
+    };
+    std::vector<Bounds> m_cellBounds; ///< Per object index: bounds of the cell it leads, unused otherwise.
+    std::vector<AkUInt8> m_cellSorted; ///< Per object index: 1 once the cell it leads is sorted along X.
+
+    static constexpr float kInvSqrt3 = 0.57735026f; ///< Cell size over threshold for a cell diagonal equal to the threshold.
+
+    std::vector<AkUInt32> m_clusterOffsets; ///< Scratch: start of each root's members in m_members.
+    std::vector<AkUInt32> m_members; ///< Scratch: object indices grouped by root.
+
+    AkUInt32 m_nextClusterId = 0; ///< Identifier given to the next cluster.
+    ClusterResult m_result; ///< Result of the last run, refilled in place.
+    Utilities m_utilities;
+};
@@ -0,0 +1,96 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "PositionBuffer.h"
+#include "ClusterResult.h"
+
+/**
+ * @brief Tuning shared by the clustering engines, applied with IClusteringEngine::configure().
+ *
+ * Engines ignore the settings that do not apply to them. Passing the settings by value
+ * lets them travel with the positions to an engine running on another thread.
+ */
+struct ClusteringSettings {
+    float distanceThreshold = 200.0f; ///< Distance threshold, see IClusteringEngine::setDistanceThreshold().
+    bool warmStart = false; ///< K-means: seed from the previous run, see KMeans::setWarmStart().
+    unsigned int coresetSize = 0; ///< K-means: initialization sample size, see KMeans::setCoresetSize().
+    unsigned int miniBatchSize = 0; ///< K-means: batch size, see KMeans::setMiniBatchSize().
+    AkUInt32 timeBudgetUs = 0; ///< K-means: time budget per run, see KMeans::setTimeBudget().
+    unsigned int threadCount = 1; ///< K-means: threads sharing each iteration, see KMeans::setThreadCount().
+    float movementEpsilon = 0.0f; ///< K-means: movement ignored between full runs, see KMeans::setIncrementalUpdates().
+    float maxChangedFraction = 0.2f; ///< K-means: changed objects allowed between full runs, see KMeans::setIncrementalUpdates().
+    float hysteresisMargin = 0.0f; ///< K-means: margin around cluster boundaries, see KMeans::setHysteresisMargin().
+
+    bool operator==(const ClusteringSettings& other) const {
+        return distanceThreshold == other.distanceThreshold && warmStart == other.warmStart
+            && coresetSize == other.coresetSize && miniBatchSize == other.miniBatchSize
+            && timeBudgetUs == other.timeBudgetUs && threadCount == other.threadCount
+            && movementEpsilon == other.movementEpsilon && maxChangedFraction == other.maxChangedFraction
+            && hysteresisMargin == other.hysteresisMargin;
+    }
+    bool operator!=(const ClusteringSettings& other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Interface of the algorithms that group audio objects into clusters.
+ *
+ * An engine takes the positions and keys of the objects to cluster and produces a
+ * ClusterResult. Objects farther than the distance threshold from every other object
+ * may end up alone in a cluster of their own; how the threshold bounds a cluster is
+ * up to each engine.
+ */
+class IClusteringEngine {
+public:
+    virtual ~IClusteringEngine() = default;
+
+    /**
+     * @brief Sets the distance threshold.
+     * @param newValue The new distance threshold value.
+     */
+    virtual void setDistanceThreshold(float newValue) = 0;
+
+    /**
+     * @brief Applies the settings that concern this engine.
+     *
+     * The default only applies the distance threshold.
+     *
+     * @param settings The settings to apply.
+     */
+    virtual void configure(const ClusteringSettings& settings) {
+        setDistanceThreshold(settings.distanceThreshold);
+    }
+
+    /**
+     * @brief Clusters the given objects, replacing the previous result.
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     */
+    virtual void cluster(const ObjectPosition* objects, AkUInt32 numObjects) = 0;
+
+    /**
+     * @brief Gets the clusters of the last call to cluster().
+     * @return The clusters, valid until the next call to cluster().
+     */
+    virtual const ClusterResult& getResult() const = 0;
+};
@@ -26,11 +26,20 @@
 #include <limits>
 #include <cmath>
 #include <algorithm>
-#include <map>
+#include <array>
+#include <chrono>
+#include <memory>
 #include <AK/SoundEngine/Common/AkTypes.h>
 #include <AK/SoundEngine/Common/AkCommonDefs.h>
 #include <AK/Plugin/PluginServices/AkMixerInputMap.h>
 #include "Utilities.h"
+#include "PositionBuffer.h"
+#include "DistanceKernels.h"
+#include "SpatialGrid.h"
+#include "KdTree.h"
+#include "ClusterResult.h"
+#include "IClusteringEngine.h"
+#include "WorkerPool.h"
 
 #undef min
 #undef max
@@ -46,27 +55,6 @@
 template <typename T>
 T clamp(T value, T min, T max);
 
-/**
- * @brief Compares two AkVector objects.
- *
- * @param a The first AkVector to compare.
- * @param b The second AkVector to compare.
- * @return true if a is considered less than b, false otherwise.
- */
-inline bool operator<(const AkVector& a, const AkVector& b) {
-    if (a.X != b.X) return a.X < b.X;
-    if (a.Y != b.Y) return a.Y < b.Y;
-    return a.Z < b.Z;
-}
-
-/**
- * @brief Represents a position and key for an audio object.
- */
-struct ObjectPosition {
-    AkVector position; ///< The 3D position of the audio object.
-    AkAudioObjectID key; ///< The unique identifier of the audio object.
-};
-
 /**
  * @brief Holds metadata about an object used during cluster initialization.
  */
@@ -102,29 +90,136 @@ struct ObjectMetadata {
  *    and the distance threshold constraints.
  */
 
-class KMeans {
+class KMeans : public IClusteringEngine {
 private:
 
     unsigned int maxClusters; ///< Maximum number of clusters.
-    unsigned int seed; ///< Seed for the random number generator.
+    unsigned int seed; ///< Seed for the random number generator used by the coreset sampling.
     float m_tolerance; ///< Tolerance for convergence.
     float m_distanceThreshold; ///< Maximum distance for a point to be considered in a cluster.
     float m_minThreshold; ///< Minimun value for the distance threshold.
     float m_maxThreshold; ///< Maximum value for the distance threshold.
     std::vector<AkVector> centroids; ///< The centroids of the clusters.
     std::vector<int> labels; ///< Labels assigning each point to a cluster.
-    std::vector<std::vector<ObjectPosition>> clusters; ///< The resulting clusters.
+
+    // Cluster membership in CSR form: the members of cluster k are
+    // m_clusterMembers[m_clusterOffsets[k]] .. m_clusterMembers[m_clusterOffsets[k + 1] - 1],
+    // as indices into m_points in ascending order.
+    std::vector<AkUInt32> m_clusterOffsets; ///< Per cluster, plus one: start of its members in m_clusterMembers.
+    std::vector<AkUInt32> m_clusterMembers; ///< Object indices grouped by cluster.
+    std::vector<AkUInt32> m_clusterCursor; ///< Scratch: fill position per cluster while building m_clusterMembers.
+    std::vector<AkVector> m_clusterSums; ///< Per cluster: sum of the member positions.
+    std::vector<double> m_clusterSumSq; ///< Per cluster: sum of the squared norms of the member positions.
+    std::vector<AkUInt32> m_clusterCounts; ///< Per cluster: number of members.
+    std::vector<AkUInt32> m_clusterIds; ///< Per cluster: identifier reported in the result.
+    AkUInt32 m_nextClusterId = 0; ///< Identifier given to the next new cluster.
+    ClusterResult m_result; ///< Result of the last run, refilled in place.
+    std::vector<AkVector> m_updatedCentroids; ///< Scratch: centroids computed by updateCentroids.
+    std::vector<ObjectMetadata> m_objectsMetadata; ///< Scratch: density per object for initializeCentroids.
+    std::vector<AkUInt32> m_nearOriginObjects; ///< Scratch: objects within the density radius of the origin.
     std::vector<float> sse_values; /// Sum of squared errors values
-    std::vector<ObjectPosition> unassignedPoints; /// A vector for unassigned points.
+    std::vector<AkUInt32> m_unassigned; ///< Indices of the objects that couldn't be assigned to any cluster.
+    PositionBuffer m_points; ///< SoA copy of the objects being clustered.
+    std::vector<int> m_nearest; ///< Nearest centroid per object, filled by the distance kernel.
+    std::vector<float> m_nearestDistanceSq; ///< Squared distance to the nearest centroid per object.
+    std::vector<float> m_secondDistanceSq; ///< Squared distance to the second nearest centroid per object.
+
+    KdTree m_centroidTree; ///< Index over the centroids, rebuilt whenever they move while m_useCentroidTree is set.
+    bool m_useCentroidTree = false; ///< True when nearest-centroid searches go through m_centroidTree.
+    static constexpr size_t kCentroidTreeMinClusters = 128; ///< Below this many centroids a linear scan is cheaper than the tree.
+
+    // Hamerly bounds, see assignPointsToClusters
+    bool m_boundsValid = false; ///< True when the bounds below describe the current centroids.
+    std::vector<float> m_upperBounds; ///< Per object: upper bound on the distance to its assigned centroid.
+    std::vector<float> m_lowerBounds; ///< Per object: lower bound on the distance to every other centroid (to all centroids if unassigned).
+    std::vector<float> m_halfSeparation; ///< Per centroid: half the distance to its nearest other centroid.
+    std::vector<float> m_centroidShift; ///< Per centroid: distance moved by the last centroid update.
+    std::vector<int> m_clusterOrigin; ///< Per cluster: index of the centroid it was assigned from, -1 if formed from unassigned points.
+    std::vector<int> m_clusterRemap; ///< Scratch: old cluster index to compacted index, -1 if removed.
+    bool m_boundsPending = false; ///< True when the per-object part of the last bound update is still to be applied.
+    float m_maxCentroidShift = 0.0f; ///< Largest entry of m_centroidShift.
+    int m_firstNewCluster = 0; ///< Index of the first cluster formed from unassigned points in the last update.
+    AkUInt32 m_boundMissCount = 0; ///< Objects whose bounds could not prove their assignment in the last bounded sweep.
+    std::vector<AkUInt32> m_newClusters; ///< Scratch: clusters formed from unassigned points in the last update.
+    std::vector<AkUInt32> m_leaderMembers; ///< Scratch: members of the cluster being formed from unassigned points.
+    std::vector<AkVector> m_previousIterationCentroids; ///< Scratch: centroids before the last update.
+    PositionBuffer m_seedCandidates; ///< Objects in descending density order, for the farthest-point selection.
+    PositionBuffer::FloatLane m_seedMinDistanceSq; ///< Per seed candidate: squared distance to the nearest chosen centroid.
+    SpatialGrid m_densityGrid; ///< Hash grid used for the density estimation in initializeCentroids.
+    AkVector m_pointsMean{ 0, 0, 0 }; ///< Mean position of the objects in the current run.
+
+    unsigned int m_coresetSize = 0; ///< Objects sampled to initialize the centroids, 0 to always use every object.
+    PositionBuffer m_coresetPoints; ///< Sampled objects, without repeats.
+    std::vector<float> m_coresetWeights; ///< Per sampled object: importance weight.
+    std::vector<double> m_coresetCdf; ///< Scratch: running sum of squared distances to the mean.
+    std::vector<AkUInt32> m_coresetSamples; ///< Scratch: drawn object indices.
+
+    unsigned int m_miniBatchSize = 0; ///< Objects per mini-batch, 0 to always run full iterations.
+    std::vector<AkUInt32> m_batchSamples; ///< Scratch: object indices drawn for the current batch.
+    std::vector<int> m_batchNearest; ///< Scratch: per batch sample, its centroid or -1 if out of reach.
+    std::vector<AkUInt32> m_batchCounts; ///< Per centroid: batch samples it has absorbed, sets its learning rate.
+
+    /**
+     * @brief Output of one chunk of the assignment sweep, combined in chunk order.
+     */
+    struct AssignChunk {
+        std::vector<AkUInt32> counts; ///< Per centroid: members in the chunk.
+        std::vector<AkVector> sums; ///< Per centroid: sum of the member positions in the chunk.
+        std::vector<double> sumSq; ///< Per centroid: sum of the squared norms of the member positions in the chunk.
+        std::vector<AkUInt32> unassigned; ///< Objects of the chunk that couldn't be assigned, ascending.
+        AkUInt32 boundMissCount = 0; ///< Objects of the chunk whose bounds failed.
+        bool changed = false; ///< True if an assignment in the chunk changed.
+    };
+
+    /// Objects per assignment chunk. Fixed, so the order the sums are added in doesn't depend
+    /// on the thread count; a multiple of the distance kernel width.
+    static constexpr AkUInt32 kAssignChunkSize = 1024;
+    std::vector<AssignChunk> m_assignChunks; ///< Per chunk of the assignment sweep.
+    unsigned int m_threadCount = 1; ///< Threads allowed on the assignment sweep, including the calling one.
+
+    // Incremental updates, see updateIncrementally. Between runs m_points holds the position
+    // each object was last assigned with, which is what the cluster sums are made of.
+    float m_movementEpsilon = 0.0f; ///< Movement below which an object keeps its cluster untouched, 0 to always run in full.
+    float m_maxChangedFraction = 0.2f; ///< Fraction of the objects that may change between full runs.
+    AkUInt32 m_changesSinceFullRun = 0; ///< Objects that moved, entered or left since the last full run.
+    std::vector<AkUInt32> m_dirtyObjects; ///< Scratch: objects to reassign in an incremental update.
+    std::vector<std::pair<AkAudioObjectID, AkUInt32>> m_previousKeys; ///< Scratch: (key, index) of the previous objects, sorted by key.
+    std::vector<int> m_previousIndex; ///< Scratch: per object, its index in the previous run, -1 if it entered.
+    std::vector<AkUInt8> m_previousMatched; ///< Scratch: per previous object, 1 if it is still there.
+    std::vector<int> m_updatedLabels; ///< Scratch: labels in the new object order.
+    PositionBuffer m_updatedPoints; ///< Scratch: last assigned positions in the new object order.
+
+    float m_hysteresisMargin = 0.0f; ///< Distance an object must gain before leaving its cluster, see applyHysteresis.
+    KdTree m_continuationTree; ///< Scratch: index over the centroids, to match the last result's clusters to them.
+    std::vector<int> m_previousContinuation; ///< Scratch: per cluster of the last result, the cluster it continues as, -1 if none.
+    std::shared_ptr<WorkerPool> m_pool; ///< Process-wide pool sharing the assignment sweep, null when single-threaded.
+
+    static constexpr unsigned int kDefaultSeed = 5489u; ///< Default seed, so runs are reproducible unless setSeed() is called.
+
+    bool m_warmStart = false; ///< Seed each run from the previous run's centroids when the scene is similar.
+    AkUInt32 m_timeBudgetUs = 0; ///< Time allowed per performClustering call in microseconds, 0 for no limit.
+    std::chrono::steady_clock::time_point m_runStart; ///< Start time of the current performClustering call.
+    bool m_resumePending = false; ///< True when the previous run was cut short by the time budget.
+    std::vector<AkVector> m_previousCentroids; ///< Converged centroids of the previous run.
+    std::vector<AkUInt32> m_previousClusterIds; ///< Identifiers of m_previousCentroids.
+    unsigned int m_previousObjectCount = 0; ///< Object count of the previous run.
+    float m_previousSpread = 0.0f; ///< RMS distance of the objects to their mean in the previous run.
+    float m_previousThreshold = 0.0f; ///< Distance threshold used by the previous run.
+
+    static constexpr float kWarmStartMaxCountChange = 0.25f; ///< Relative object count change that forces a full initialization.
+    static constexpr float kWarmStartMaxSpreadChange = 0.25f; ///< Relative spread change that forces a full initialization.
+
+    static constexpr unsigned int kGaussianTableSize = 256; ///< Number of intervals in the Gaussian weight table.
+    std::array<float, kGaussianTableSize + 1> m_gaussianTable; ///< exp(-t / 2) sampled over t = d^2 / r^2 in [0, 1].
     Utilities m_utilities;
 
 
     /**
      * @brief Retrieves points that couldn't be assigned to any cluster due to distance constraints.
-     * @return A const reference to the vector of unassigned object positions.
+     * @return A const reference to the indices of the unassigned objects.
      */
-    const std::vector<ObjectPosition>& KMeans::getUnassignedPoints() const {
-        return unassignedPoints;
+    const std::vector<AkUInt32>& getUnassignedPoints() const {
+        return m_unassigned;
     }
 
     /**
@@ -135,10 +230,64 @@ private:
     unsigned int determineMaxClusters(unsigned int numObjects);
 
     /**
-     * @brief Initializes the centroids for the K-means algorithm.
-     * @param points The points to initialize centroids from.
+     * @brief Initializes the centroids for the K-means algorithm from the buffered objects.
+     *
+     * With a coreset size set and more objects than that, the density estimation and
+     * the farthest-point selection run on a weighted sample instead of every object.
+     */
+    void initializeCentroids();
+
+    /**
+     * @brief Calculates the RMS distance of the buffered objects to their mean position.
+     * @param mean Receives the mean position.
+     * @return The spread of the objects, 0 if there are none.
      */
-    void initializeCentroids(const std::vector<ObjectPosition>& objects);
+    float calculateSpread(AkVector& mean) const;
+
+    /**
+     * @brief Draws a weighted sample of the buffered objects into m_coresetPoints.
+     *
+     * Each of m_coresetSize draws picks an object with probability
+     * q(x) = 1 / (2N) + d(x, mean)^2 / (2 sum d^2), and the object is weighted by
+     * 1 / (m_coresetSize q(x)) so weighted sums over the sample estimate sums over all
+     * objects. Beyond one pass to compute q, the cost only depends on m_coresetSize.
+     */
+    void sampleCoreset();
+
+    /**
+     * @brief Refines the centroids from random batches of m_miniBatchSize objects.
+     *
+     * Each batch is labelled against the centroids as they were when it was drawn, then
+     * every centroid steps towards each of its samples with a rate of 1 / (samples it
+     * has absorbed so far), so early batches move the centroids freely and later ones
+     * only fine-tune them. Samples farther than the distance threshold from every
+     * centroid start new centroids, the same way unassigned objects do in a full
+     * iteration: only leader groups of at least two distinct objects do. Labels, cluster sums and counts are not touched; the caller runs one
+     * full assignment afterwards.
+     *
+     * @param maxBatches The maximum number of batches, further capped so that no more
+     * samples are drawn than there are objects.
+     * @return True if the time budget ran out before the batches converged.
+     */
+    bool runMiniBatches(unsigned int maxBatches);
+
+    /**
+     * @brief Checks whether the current run has used up its time budget.
+     */
+    bool budgetExhausted() const;
+
+    /**
+     * @brief Checks whether the previous run's centroids are a good enough seed for this run.
+     *
+     * Only considered with warm starting enabled, or to resume a run that the time budget
+     * cut short. It is refused when the distance threshold changed, or when the object
+     * count or spread moved by more than kWarmStartMaxCountChange / kWarmStartMaxSpreadChange.
+     *
+     * @param numObjects The number of objects in this run.
+     * @param spread The spread of the objects in this run.
+     * @return True if the iteration can be seeded from the previous centroids.
+     */
+    bool canWarmStart(unsigned int numObjects, float spread) const;
 
     /**
      * @brief Calculates the squared distance between two points.
@@ -150,10 +299,76 @@ private:
 
     /**
      * @brief Assigns points to the nearest cluster.
-     * @param objects The objects to assign to clusters.
+     *
+     * Uses Hamerly's bounds to skip objects whose assignment provably cannot change:
+     * an object keeps its centroid without any distance evaluation when the upper
+     * bound on its distance to that centroid is below both the lower bound on its
+     * distance to any other centroid and half the distance from its centroid to the
+     * nearest other centroid, and is also within the distance threshold. Unassigned
+     * objects are skipped while their lower bound stays beyond the threshold.
+     *
+     * The bound update, the assignment and the accumulation of the per-cluster sums
+     * used by the centroids and the SSE all happen in one sweep over the objects.
+     *
      * @return True if any assignments changed, false otherwise.
      */
-    bool assignPointsToClusters(const std::vector<ObjectPosition>& objects);
+    bool assignPointsToClusters();
+
+    /**
+     * @brief Assigns one chunk of objects and accumulates its per-cluster sums.
+     *
+     * Touches only the chunk's objects and its AssignChunk, so chunks can run on
+     * different threads.
+     *
+     * @param chunk Index of the chunk, covering kAssignChunkSize objects.
+     * @param fullSweep True to search every object, false to rely on the bounds.
+     * @param useKernel True if the nearest centroids come from the distance kernel.
+     */
+    void assignChunk(AkUInt32 chunk, bool fullSweep, bool useKernel);
+
+    /**
+     * @brief Rebuilds m_centroidTree from the current centroids if there are enough of them to use it.
+     */
+    void refreshCentroidTree();
+
+    /**
+     * @brief Finds the nearest and second nearest centroid of a single object.
+     *
+     * With m_useCentroidTree set, the search stops at twice the distance threshold:
+     * centroids beyond it are reported at that distance, a lower bound on the real one.
+     *
+     * @param index The index of the object in m_points.
+     * @param outNearest Receives the nearest centroid index, -1 if there are no centroids (or none within the search radius).
+     * @param outDistanceSq Receives the squared distance to the nearest centroid.
+     * @param outSecondDistanceSq Receives the squared distance to the second nearest centroid.
+     */
+    void findNearestCentroid(AkUInt32 index, int& outNearest, float& outDistanceSq, float& outSecondDistanceSq) const;
+
+    /**
+     * @brief Recomputes m_halfSeparation for the current centroids.
+     */
+    void updateCentroidSeparation();
+
+    /**
+     * @brief Prepares carrying the per-object bounds over a centroid update.
+     *
+     * Must be called after centroids were rebuilt from m_previousIterationCentroids
+     * following m_clusterOrigin. Computes the centroid shifts; the objects themselves
+     * are updated by carryBounds during the next assignment sweep.
+     */
+    void updateBounds();
+
+    /**
+     * @brief Carries the bounds of one object over the last centroid update.
+     *
+     * Upper bounds grow by the shift of the assigned centroid, lower bounds shrink by
+     * the largest shift, and clusters newly formed from unassigned points lower the
+     * bounds through the triangle inequality.
+     *
+     * @param index The index of the object in m_points.
+     * @param position The position of the object.
+     */
+    void carryBounds(AkUInt32 index, const AkVector& position);
 
     /**
      * @brief Updates the centroids based on the current cluster assignments.
@@ -175,22 +390,57 @@ private:
      * centroid. A lower SSE indicates a better clustering result, as it means the data points
      * are closer to their centroids on average.
      *
+     * Computed from the per-cluster sums gathered during assignment, without another
+     * pass over the objects.
+     *
      * @return The calculated Sum of Squared Errors for the current clustering.
      */
     float calculateSSE() const;
 
     /**
-     * @brief Calculates the centroid of a cluster of object positions.
+     * @brief Calculates the centroid of a cluster from its cached member sum.
      *
-     * This function computes the average position (centroid) of all objects in a given cluster.
      * If the cluster is empty, it returns a zero vector.
      *
-     * @param cluster A vector of ObjectPosition representing a cluster of objects.
-     * @return AkVector The calculated centroid of the cluster.
+     * @param cluster The cluster index.
+     * @return AkVector The average position of the cluster members.
+     */
+    AkVector calculateCentroid(size_t cluster) const;
+
+    /**
+     * @brief Appends a cluster to the per-cluster sums and counts.
+     *
+     * The members must have their labels set to the new cluster index by the caller.
+     *
+     * @param members Indices of the member objects, ascending.
+     */
+    void appendCluster(const std::vector<AkUInt32>& members);
+
+    /**
+     * @brief Removes clusters without members from the sums and counts and relabels the objects.
+     *
+     * Fills m_clusterOrigin with the previous index of every remaining cluster.
+     *
+     * @return True if any cluster was removed.
+     */
+    bool removeEmptyClusters();
+
+    /**
+     * @brief Rebuilds the CSR membership lists from the labels and m_clusterCounts.
      *
+     * Only the result needs the lists, so this runs once per clustering run.
+     */
+    void buildClusterMembership();
+
+    /**
+     * @brief Gives every current centroid a new cluster identifier.
      */
+    void assignNewClusterIds();
 
-    AkVector calculateCentroid(const std::vector<ObjectPosition>& cluster);
+    /**
+     * @brief Refills m_result from the current membership.
+     */
+    void fillResult();
 
     /**
      * @brief Adjusts the number and composition of clusters based on the distance threshold.
@@ -201,8 +451,79 @@ private:
     */
     void adjustClusterCount();
 
+    /**
+     * @brief Updates the previous run's clusters for the objects that changed, if few enough did.
+     *
+     * An object is dirty when it entered, or moved more than the movement epsilon from
+     * the position it was last assigned with. Objects that left and dirty objects are
+     * taken out of their cluster sums, dirty objects are assigned to the nearest
+     * centroid within the threshold and added back, and the centroids are recomputed
+     * from the sums. Clusters left empty are removed and the unassigned objects are
+     * grouped by formLeaderClusters(), as in a full run. Clean objects are not looked at beyond the
+     * movement test, so a static scene costs one pass over the positions.
+     *
+     * Centroids drift as objects join and leave, so a full run takes over once the
+     * objects changed since the last one exceed the allowed fraction.
+     *
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     * @return True if the clusters were updated, false if a full run is needed.
+     */
+    bool updateIncrementally(const ObjectPosition* objects, AkUInt32 numObjects);
+
+    /**
+     * @brief Keeps objects near a cluster boundary in the cluster they had in the last result.
+     *
+     * Each cluster of the last result continues as the current cluster whose centroid is
+     * nearest to its old centroid, within the threshold. An object labelled differently
+     * from the continuation of its previous cluster goes back to it, unless it is farther
+     * than the threshold plus the margin from it or the new centroid is closer by more
+     * than the margin. Centroids are then recomputed from the sums and clusters left
+     * empty are removed. Clusters are matched by position, not by ID, so this works the
+     * same after a cold start that gave every cluster a new ID.
+     *
+     * @param candidates Objects that may have changed cluster, or null for all of them.
+     */
+    void applyHysteresis(const std::vector<AkUInt32>* candidates);
+
+    /**
+     * @brief Removes an object's last assigned position from its cluster sums.
+     */
+    void removeFromCluster(int cluster, const AkVector& position);
+
+    /**
+     * @brief Adds an object's position to its cluster sums.
+     */
+    void addToCluster(int cluster, const AkVector& position);
+
+    /**
+     * @brief Removes one leader cluster from a list of unassigned objects.
+     *
+     * The first remaining object becomes the leader and every remaining object within
+     * the distance threshold of it joins its cluster, in list order. The objects left
+     * behind are compacted in place during the same sweep, so regrouping U objects into
+     * L clusters costs O(U * L) without any vector::erase.
+     *
+     * @param remaining Indices of the objects still unassigned; members are removed.
+     * @param outMembers Receives the leader followed by the other members.
+     */
+    void extractLeaderCluster(std::vector<AkUInt32>& remaining, std::vector<AkUInt32>& outMembers) const;
+
+    /**
+     * @brief Groups the objects of m_unassigned into leader clusters, emptying it.
+     *
+     * Only groups of more than one object become clusters; an object with nobody
+     * within the threshold stays unassigned. Centroids are left to the caller.
+     * @return True if a cluster was formed.
+     */
+    bool formLeaderClusters();
+
     /**
      * @brief Calculates the Gaussian weight based on squared distance and radius
+     *
+     * Inside the radius the weight is linearly interpolated from a precomputed table
+     * instead of calling std::exp for every pair.
+     *
      * @param distanceSquared The squared distance between two points
      * @param radiusSquared The squared radius of influence
      * @return The calculated weight
@@ -233,7 +554,7 @@ public:
      * @brief Sets the distance threshold.
      * @param newValue The new distance threshold value.
      */
-    void setDistanceThreshold(float newValue);
+    void setDistanceThreshold(float newValue) override;
 
     /**
      * @brief Sets the internal minimun distance threshold value.
@@ -245,12 +566,130 @@ public:
     */
     void setMaxDistanceThreshold(float newValue);
 
+    /**
+     * @brief Enables or disables seeding from the previous run's converged centroids.
+     *
+     * Object motion between two audio frames is small, so the previous centroids are
+     * usually within a couple of iterations of the new solution. A full density and
+     * k-means++ initialization still runs whenever canWarmStart() refuses the seed.
+     */
+    void setWarmStart(bool enabled);
+
+    /**
+     * @brief Sets the number of objects sampled to initialize the centroids.
+     *
+     * Initialization cost grows with the number of candidates, which matters for
+     * particle-style buses with thousands of short-lived objects. When the object count
+     * exceeds this size, the centroids are initialized from a weighted random sample of
+     * that many objects, and the full assignment then runs on every object.
+     *
+     * @param size The sample size, 0 to always initialize from every object.
+     */
+    void setCoresetSize(unsigned int size);
+
+    /**
+     * @brief Sets the seed of the coreset sampling.
+     *
+     * The generator is reseeded for every sample, so identical inputs give identical results.
+     */
+    void setSeed(unsigned int newSeed);
+
+    /**
+     * @brief Sets the batch size of the mini-batch mode.
+     *
+     * A full iteration labels every object, which gets too expensive for a single audio
+     * frame once a bus carries tens of thousands of objects. When the object count
+     * exceeds this size, the iterations of performClustering() update the centroids
+     * from random batches of this many objects instead, and every object is labelled
+     * only once, at the end. The result is an approximation of the full iterations
+     * with the same distance threshold and unassigned-object handling.
+     *
+     * @param size The batch size, 0 to always run full iterations.
+     */
+    void setMiniBatchSize(unsigned int size);
+
+    /**
+     * @brief Sets the time allowed for each performClustering() call.
+     *
+     * Once the budget is spent, the iterations stop after the current one and the
+     * clustering reached so far is published. The next call then resumes refining from
+     * the centroids it stopped at, like a warm start, unless the scene changed too much
+     * for them to be a useful seed. Initialization and the first iteration always run
+     * in full, so a very small budget still yields a complete result.
+     *
+     * @param microseconds The budget in microseconds, 0 for no limit.
+     */
+    void setTimeBudget(AkUInt32 microseconds);
+
+    /**
+     * @brief Sets the number of threads sharing the assignment sweep of each iteration.
+     *
+     * The objects are split into chunks of kAssignChunkSize that the process-wide
+     * WorkerPool works through, and the per-chunk sums are combined in chunk order, so
+     * the result is the same for any thread count. Scenes of a single chunk always run
+     * on the calling thread. Instances share the pool, which only grows to the largest
+     * count any of them asked for. This never creates threads itself: it asks the pool's
+     * workers to, see WorkerPool::requestThreads(), so threads the pool should start with
+     * are reserved up front.
+     *
+     * @param count The number of threads including the calling one, 1 to run serially.
+     */
+    void setThreadCount(unsigned int count);
+
+    /**
+     * @brief Enables incremental updates between full runs.
+     *
+     * When only a few objects entered, left or moved more than the epsilon since the
+     * last run, performClustering() reassigns just those against the current clusters
+     * instead of clustering from scratch, see updateIncrementally().
+     *
+     * @param movementEpsilon Movement below which an object keeps its cluster, 0 to always run in full.
+     * @param maxChangedFraction Fraction of the objects that may change before a full run, in [0, 1].
+     */
+    void setIncrementalUpdates(float movementEpsilon, float maxChangedFraction);
+
+    /**
+     * @brief Sets the hysteresis band around cluster boundaries.
+     *
+     * An object only changes cluster between runs when its new centroid is closer than
+     * the old one by more than the margin, or when it is farther than the distance
+     * threshold plus the margin from the old one, see applyHysteresis().
+     *
+     * @param margin The margin in distance units, 0 to disable.
+     */
+    void setHysteresisMargin(float margin);
+
+    /**
+     * @brief Performs K-means clustering on the given objects.
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     * @param max_iterations The maximum number of iterations.
+     */
+    void performClustering(const ObjectPosition* objects, AkUInt32 numObjects, unsigned int max_iterations = 20);
+
     /**
      * @brief Performs K-means clustering on the given objects.
      * @param objects The objects to cluster.
      * @param max_iterations The maximum number of iterations.
      */
-    void performClustering(const std::vector<ObjectPosition>& objects, unsigned int max_iterations = 20);
+    void performClustering(const std::vector<ObjectPosition>& objects, unsigned int max_iterations = 20) {
+        performClustering(objects.data(), static_cast<AkUInt32>(objects.size()), max_iterations);
+    }
+
+    /**
+     * @brief Applies the distance threshold and every K-means specific setting.
+     * @param settings The settings to apply.
+     */
+    void configure(const ClusteringSettings& settings) override;
+
+    /**
+     * @brief Performs K-means clustering on the given objects with the default iteration limit.
+     * @param objects The objects to cluster.
+     * @param numObjects The number of objects.
+     */
+    void cluster(const ObjectPosition* objects, AkUInt32 numObjects) override {
+        performClustering(objects, numObjects);
+    }
 
     /**
      * @brief Gets the cluster labels for each object.
@@ -265,8 +704,12 @@ public:
     const std::vector<AkVector>& getCentroids() const;
 
     /**
-     * @brief Gets the resulting clusters as a map of AkVectors to object IDs.
-     * @return The clusters.
+     * @brief Gets the clusters found by the last run.
+     *
+     * A cluster keeps its id while it survives from one iteration to the next,
+     * including across runs seeded by a warm start.
+     *
+     * @return The clusters, valid until the next call to performClustering.
      */
-    std::map<AkVector, std::vector<AkAudioObjectID>> getClusters() const;
+    const ClusterResult& getResult() const override;
 };
\ No newline at end of file
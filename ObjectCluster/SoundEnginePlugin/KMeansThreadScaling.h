@@ -0,0 +1,141 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+
+/*
+ * Standalone benchmark of the KMeans thread count, not part of the plugin build.
+ * Clusters the same scenes with 1, 2, 4, ... threads and prints the time per run,
+ * the speedup over one thread and whether the result matches the one-thread run.
+ * Thread counts go up to the hardware thread count, or to the first argument if given.
+ *
+ * Build it with the plugin sources other than ObjectClusterFX*.cpp and the Wwise SDK
+ * headers, for example:
+ *   g++ -std=c++17 -O2 -I$WWISESDK/include -x c++ KMeansThreadScaling.h -x none
+ *       Kmeans.cpp WorkerPool.cpp ... -lpthread
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <thread>
+#include <vector>
+#include "KMeans.h"
+#include "WorkerPool.h"
+
+namespace {
+    /**
+     * @brief Scatters objects around blobs of about 40 objects each, like ships in formation.
+     */
+    std::vector<ObjectPosition> makeScene(AkUInt32 numObjects, unsigned int seed)
+    {
+        std::mt19937 generator(seed);
+        std::uniform_real_distribution<float> blobDistribution(-20000.0f, 20000.0f);
+        std::uniform_real_distribution<float> offsetDistribution(-150.0f, 150.0f);
+
+        std::vector<AkVector> blobs(std::max(numObjects / 40, 1u));
+        for (AkVector& blob : blobs) {
+            blob = AkVector{ blobDistribution(generator), blobDistribution(generator), blobDistribution(generator) };
+        }
+
+        std::vector<ObjectPosition> objects(numObjects);
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            const AkVector& blob = blobs[generator() % blobs.size()];
+            objects[i].position = AkVector{ blob.X + offsetDistribution(generator),
+                blob.Y + offsetDistribution(generator), blob.Z + offsetDistribution(generator) };
+            objects[i].key = static_cast<AkAudioObjectID>(i);
+        }
+        return objects;
+    }
+
+    /**
+     * @brief Flattens a result into centroids and member counts, to compare runs bit for bit.
+     */
+    std::vector<float> signatureOf(const ClusterResult& result)
+    {
+        std::vector<float> signature;
+        for (const ClusterView& cluster : result) {
+            signature.push_back(cluster.centroid.X);
+            signature.push_back(cluster.centroid.Y);
+            signature.push_back(cluster.centroid.Z);
+            signature.push_back(static_cast<float>(cluster.members.size()));
+        }
+        return signature;
+    }
+}
+
+int main(int argc, char** argv) {
+    const AkUInt32 sceneSizes[] = { 5000, 20000, 60000 };
+    const int numRuns = 5;
+
+    const unsigned int requestedThreads = argc > 1 ? static_cast<unsigned int>(std::atoi(argv[1])) : std::thread::hardware_concurrency();
+    const unsigned int maxThreads = std::min(std::max(requestedThreads, 1u), WorkerPool::kMaxThreads);
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    // setThreadCount() only asks the pool's workers for threads, so create them up front
+    WorkerPool::acquireShared()->reserveThreads(maxThreads);
+    std::cout << "Hardware threads: " << std::thread::hardware_concurrency() << "\n";
+
+    for (AkUInt32 numObjects : sceneSizes) {
+        const std::vector<ObjectPosition> objects = makeScene(numObjects, 7);
+
+        double serialMs = 0.0;
+        std::vector<float> serialSignature;
+        for (unsigned int threads : threadCounts) {
+            KMeans kmeans;
+            kmeans.setMinDistanceThreshold(1.f);
+            kmeans.setMaxDistanceThreshold(1000.f);
+            kmeans.setDistanceThreshold(200.f);
+            kmeans.setThreadCount(threads);
+
+            // The first run sizes the buffers
+            kmeans.performClustering(objects);
+
+            double bestMs = std::numeric_limits<double>::max();
+            for (int run = 0; run < numRuns; ++run) {
+                const auto start = std::chrono::steady_clock::now();
+                kmeans.performClustering(objects);
+                const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+                bestMs = std::min(bestMs, ms);
+            }
+
+            const std::vector<float> signature = signatureOf(kmeans.getResult());
+            if (threads == 1) {
+                serialMs = bestMs;
+                serialSignature = signature;
+            }
+            const bool identical = signature.size() == serialSignature.size()
+                && std::memcmp(signature.data(), serialSignature.data(), signature.size() * sizeof(float)) == 0;
+
+            std::cout << numObjects << " objects, " << threads << " threads: " << bestMs << " ms, "
+                << serialMs / bestMs << "x, " << kmeans.getResult().size() << " clusters, "
+                << (identical ? "identical" : "DIFFERENT") << "\n";
+        }
+    }
+}
@@ -0,0 +1,148 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "KdTree.h"
+#include <algorithm>
+
+namespace {
+    // A candidate is better when it is closer, or as close with a lower index
+    bool isBetter(float distanceSq, int index, float bestDistanceSq, int bestIndex)
+    {
+        if (bestIndex < 0) return distanceSq <= bestDistanceSq;
+        return distanceSq < bestDistanceSq || (distanceSq == bestDistanceSq && index < bestIndex);
+    }
+}
+
+void KdTree::build(const AkVector* points, AkUInt32 count)
+{
+    m_points.assign(points, points + count);
+    m_order.resize(count);
+    for (AkUInt32 i = 0; i < count; ++i) {
+        m_order[i] = i;
+    }
+
+    m_nodes.clear();
+    if (count > 0) {
+        buildNode(0, count);
+    }
+}
+
+AkUInt32 KdTree::buildNode(AkUInt32 begin, AkUInt32 end)
+{
+    const AkUInt32 nodeIndex = static_cast<AkUInt32>(m_nodes.size());
+    m_nodes.push_back({ begin, end, -1, 0.0f, 0, 0 });
+    if (end - begin <= kLeafSize) {
+        return nodeIndex;
+    }
+
+    // Split the widest axis at the median
+    AkVector lo = m_points[m_order[begin]];
+    AkVector hi = lo;
+    for (AkUInt32 i = begin + 1; i < end; ++i) {
+        const AkVector& p = m_points[m_order[i]];
+        lo.X = std::min(lo.X, p.X); hi.X = std::max(hi.X, p.X);
+        lo.Y = std::min(lo.Y, p.Y); hi.Y = std::max(hi.Y, p.Y);
+        lo.Z = std::min(lo.Z, p.Z); hi.Z = std::max(hi.Z, p.Z);
+    }
+    const float extentX = hi.X - lo.X;
+    const float extentY = hi.Y - lo.Y;
+    const float extentZ = hi.Z - lo.Z;
+    const AkInt32 axis = (extentX >= extentY && extentX >= extentZ) ? 0 : (extentY >= extentZ ? 1 : 2);
+
+    const AkUInt32 mid = begin + (end - begin) / 2;
+    std::nth_element(m_order.begin() + begin, m_order.begin() + mid, m_order.begin() + end,
+        [&](AkUInt32 a, AkUInt32 b) { return coordinate(m_points[a], axis) < coordinate(m_points[b], axis); });
+    const float split = coordinate(m_points[m_order[mid]], axis);
+
+    // m_nodes may reallocate while the children are built, so only touch it by index
+    const AkUInt32 left = buildNode(begin, mid);
+    const AkUInt32 right = buildNode(mid, end);
+    m_nodes[nodeIndex].axis = axis;
+    m_nodes[nodeIndex].split = split;
+    m_nodes[nodeIndex].left = left;
+    m_nodes[nodeIndex].right = right;
+    return nodeIndex;
+}
+
+template <int NumCandidates>
+void KdTree::search(AkUInt32 nodeIndex, const AkVector& query, Candidates& best) const
+{
+    const Node& node = m_nodes[nodeIndex];
+
+    if (node.axis < 0) {
+        for (AkUInt32 i = node.begin; i < node.end; ++i) {
+            const int index = static_cast<int>(m_order[i]);
+            const AkVector& p = m_points[index];
+            const float dx = p.X - query.X;
+            const float dy = p.Y - query.Y;
+            const float dz = p.Z - query.Z;
+            const float distanceSq = dx * dx + dy * dy + dz * dz;
+
+            if (isBetter(distanceSq, index, best.distanceSq[0], best.index[0])) {
+                if (NumCandidates > 1) {
+                    best.distanceSq[1] = best.distanceSq[0];
+                    best.index[1] = best.index[0];
+                }
+                best.distanceSq[0] = distanceSq;
+                best.index[0] = index;
+            }
+            else if (NumCandidates > 1 && isBetter(distanceSq, index, best.distanceSq[1], best.index[1])) {
+                best.distanceSq[1] = distanceSq;
+                best.index[1] = index;
+            }
+        }
+        return;
+    }
+
+    // Near side first, the far side only if the split plane is within the current bound
+    const float offset = coordinate(query, node.axis) - node.split;
+    const AkUInt32 nearChild = offset < 0.0f ? node.left : node.right;
+    const AkUInt32 farChild = offset < 0.0f ? node.right : node.left;
+
+    search<NumCandidates>(nearChild, query, best);
+    if (offset * offset <= best.distanceSq[NumCandidates - 1]) {
+        search<NumCandidates>(farChild, query, best);
+    }
+}
+
+int KdTree::findNearest(const AkVector& query, float radius, float& outDistanceSq) const
+{
+    Candidates best{ { radius * radius, radius * radius }, { -1, -1 } };
+    if (!m_nodes.empty()) {
+        search<1>(0, query, best);
+    }
+
+    outDistanceSq = best.distanceSq[0];
+    return best.index[0];
+}
+
+void KdTree::findNearestTwo(const AkVector& query, float radius, int& outNearest, float& outDistanceSq, float& outSecondDistanceSq) const
+{
+    Candidates best{ { radius * radius, radius * radius }, { -1, -1 } };
+    if (!m_nodes.empty()) {
+        search<2>(0, query, best);
+    }
+
+    outNearest = best.index[0];
+    outDistanceSq = best.distanceSq[0];
+    outSecondDistanceSq = best.distanceSq[1];
+}
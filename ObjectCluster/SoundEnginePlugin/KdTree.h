@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/**
+ * @brief Static k-d tree over a small set of 3D points, for radius-bounded nearest queries.
+ *
+ * Meant to be rebuilt whenever the points move (once per frame for output objects,
+ * once per iteration for centroids): a build costs O(M log M) for M points and
+ * reuses the storage of the previous build. Nodes split the widest axis at the
+ * median, and leaves hold up to kLeafSize points.
+ *
+ * Queries only visit the nodes that can hold a point closer than the best found so
+ * far, starting from the search radius, which is O(log M) for well spread points.
+ * Ties are resolved towards the lower point index, so results do not depend on the
+ * tree layout.
+ */
+class KdTree {
+public:
+    /**
+     * @brief Rebuilds the tree over a set of points.
+     * @param points The points; query results are indices into this array.
+     * @param count The number of points.
+     */
+    void build(const AkVector* points, AkUInt32 count);
+
+    /**
+     * @brief Gets the number of points in the tree.
+     */
+    AkUInt32 size() const { return static_cast<AkUInt32>(m_points.size()); }
+
+    /**
+     * @brief Finds the nearest point within a radius.
+     * @param query The query position.
+     * @param radius The search radius, inclusive.
+     * @param outDistanceSq Receives the squared distance to the nearest point, or radius squared if there is none.
+     * @return The index of the nearest point, or -1 if no point is within the radius.
+     */
+    int findNearest(const AkVector& query, float radius, float& outDistanceSq) const;
+
+    /**
+     * @brief Finds the nearest and second nearest points within a radius.
+     *
+     * Missing neighbours are reported at the radius, which is a lower bound on their
+     * actual distance.
+     *
+     * @param query The query position.
+     * @param radius The search radius, inclusive.
+     * @param outNearest Receives the index of the nearest point, or -1 if no point is within the radius.
+     * @param outDistanceSq Receives the squared distance to the nearest point.
+     * @param outSecondDistanceSq Receives the squared distance to the second nearest point.
+     */
+    void findNearestTwo(const AkVector& query, float radius, int& outNearest, float& outDistanceSq, float& outSecondDistanceSq) const;
+
+private:
+    static constexpr AkUInt32 kLeafSize = 8; ///< Maximum number of points in a leaf.
+
+    /**
+     * @brief Node of the tree; leaves have a negative axis.
+     */
+    struct Node {
+        AkUInt32 begin; ///< First point of the subtree in m_order.
+        AkUInt32 end; ///< One past the last point of the subtree in m_order.
+        AkInt32 axis; ///< Split axis (0 = X, 1 = Y, 2 = Z), -1 for a leaf.
+        float split; ///< Coordinate of the split plane along the axis.
+        AkUInt32 left; ///< Child with the points below the split.
+        AkUInt32 right; ///< Child with the points above the split.
+    };
+
+    /**
+     * @brief Best points found so far by a query, nearest first.
+     */
+    struct Candidates {
+        float distanceSq[2];
+        int index[2];
+    };
+
+    /**
+     * @brief Builds the subtree over m_order[begin, end) and returns its node index.
+     */
+    AkUInt32 buildNode(AkUInt32 begin, AkUInt32 end);
+
+    /**
+     * @brief Searches a subtree, keeping the best one or two candidates.
+     */
+    template <int NumCandidates>
+    void search(AkUInt32 node, const AkVector& query, Candidates& best) const;
+
+    static float coordinate(const AkVector& v, AkInt32 axis) {
+        return axis == 0 ? v.X : (axis == 1 ? v.Y : v.Z);
+    }
+
+    std::vector<AkVector> m_points; ///< Copy of the points, by original index.
+    std::vector<AkUInt32> m_order; ///< Point indices, grouped by subtree.
+    std::vector<Node> m_nodes; ///< Nodes, the root first.
+};
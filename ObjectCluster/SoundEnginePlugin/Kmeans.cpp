@@ -30,11 +30,21 @@ unsigned int KMeans::determineMaxClusters(unsigned int numObjects) {
     return static_cast<unsigned int>(std::sqrt(numObjects));
 }
 
-void KMeans::initializeCentroids(const std::vector<ObjectPosition>& objects) {
-    if (objects.empty()) return;
+void KMeans::initializeCentroids() {
+    if (m_points.empty()) return;
+
+    // Large scenes are initialized from a weighted sample, everything else from all objects
+    const PositionBuffer* source = &m_points;
+    const float* sourceWeights = nullptr;
+    if (m_coresetSize > 0 && m_points.size() > m_coresetSize) {
+        sampleCoreset();
+        source = &m_coresetPoints;
+        sourceWeights = m_coresetWeights.data();
+    }
+    const PositionBuffer& candidates = *source;
 
-    std::vector<ObjectMetadata> objectsMetadata;
-    objectsMetadata.reserve(objects.size());
+    std::vector<ObjectMetadata>& objectsMetadata = m_objectsMetadata;
+    objectsMetadata.clear();
 
     // Calculate local density including origin region
     const float densityRadius = m_distanceThreshold * 0.5f;
@@ -42,25 +52,31 @@ void KMeans::initializeCentroids(const std::vector<ObjectPosition>& objects) {
 
     // Track density around origin specifically
     float originDensity = 0.0f;
-    std::vector<const ObjectPosition*> nearOriginObjects;
+    m_nearOriginObjects.clear();
+
+    // Bucket objects by cells of densityRadius, so only the 27 cells around an object can hold neighbours
+    m_densityGrid.build(candidates, densityRadius);
 
-    for (const auto& obj : objects) {
+    for (AkUInt32 i = 0; i < candidates.size(); ++i) {
+        const ObjectPosition obj{ candidates.position(i), candidates.key(i) };
+        const float weight = sourceWeights ? sourceWeights[i] : 1.0f;
         float localDensity = 0.0f;
 
         // Calculate density contribution to origin
         float distToOriginSq = m_utilities.GetDistanceSquared(obj.position, AkVector{ 0,0,0 });
         if (distToOriginSq < densityRadiusSq) {
-            nearOriginObjects.push_back(&obj);
-            originDensity += calculateGaussianWeight(distToOriginSq, densityRadiusSq);
+            m_nearOriginObjects.push_back(i);
+            originDensity += calculateGaussianWeight(distToOriginSq, densityRadiusSq) * weight;
         }
 
         // Calculate local density relative to other points
-        for (const auto& neighbor : objects) {
-            float distSq = m_utilities.GetDistanceSquared(obj.position, neighbor.position);
+        m_densityGrid.forEachNeighbor(obj.position, [&](AkUInt32 neighbor) {
+            float distSq = m_utilities.GetDistanceSquared(obj.position, candidates.position(neighbor));
             if (distSq < densityRadiusSq) {
-                localDensity += calculateGaussianWeight(distSq, densityRadiusSq);
+                const float neighborWeight = sourceWeights ? sourceWeights[neighbor] : 1.0f;
+                localDensity += calculateGaussianWeight(distSq, densityRadiusSq) * neighborWeight;
             }
-        }
+        });
 
         objectsMetadata.push_back({ obj, localDensity, std::numeric_limits<float>::max() });
     }
@@ -74,19 +90,20 @@ void KMeans::initializeCentroids(const std::vector<ObjectPosition>& objects) {
     centroids.clear();
 
     // If we have significant density near origin, calculate optimal centroid position
-    if (!nearOriginObjects.empty()) {
+    if (!m_nearOriginObjects.empty()) {
         AkVector originCluster{ 0,0,0 };
         float totalWeight = 0.0f;
 
         // Calculate weighted average position for objects near origin
-        for (const auto* obj : nearOriginObjects) {
+        for (AkUInt32 index : m_nearOriginObjects) {
+            const AkVector position = candidates.position(index);
             float weight = calculateGaussianWeight(
-                m_utilities.GetDistanceSquared(obj->position, AkVector{ 0,0,0 }),
+                m_utilities.GetDistanceSquared(position, AkVector{ 0,0,0 }),
                 densityRadiusSq
-            );
-            originCluster.X += obj->position.X * weight;
-            originCluster.Y += obj->position.Y * weight;
-            originCluster.Z += obj->position.Z * weight;
+            ) * (sourceWeights ? sourceWeights[index] : 1.0f);
+            originCluster.X += position.X * weight;
+            originCluster.Y += position.Y * weight;
+            originCluster.Z += position.Z * weight;
             totalWeight += weight;
         }
 
@@ -103,154 +120,667 @@ void KMeans::initializeCentroids(const std::vector<ObjectPosition>& objects) {
         centroids.push_back(objectsMetadata[0].object.position);
     }
 
-    // Continue with k-means++ initialization for remaining centroids
+    // Continue with k-means++ initialization for remaining centroids.
+    // Keep each candidate's distance to its nearest centroid and only fold in the newest centroid per round.
+    const AkUInt32 numCandidates = static_cast<AkUInt32>(objectsMetadata.size());
+    m_seedCandidates.resize(numCandidates);
+    for (AkUInt32 i = 0; i < numCandidates; ++i) {
+        m_seedCandidates.set(i, objectsMetadata[i].object.position, objectsMetadata[i].object.key);
+    }
+
+    // Padding slots hold a negative distance so they are never picked
+    m_seedMinDistanceSq.assign(m_seedCandidates.paddedSize(), -1.0f);
+    std::fill(m_seedMinDistanceSq.begin(), m_seedMinDistanceSq.begin() + numCandidates, std::numeric_limits<float>::max());
+
+    float maxMinDistanceSq = 0.0f;
+    int bestCandidate = -1;
+    for (const auto& centroid : centroids) {
+        bestCandidate = DistanceKernels::updateFarthestPoint(m_seedCandidates, centroid, m_seedMinDistanceSq.data(), maxMinDistanceSq);
+    }
+
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
     while (centroids.size() < maxClusters) {
-        float maxMinDistance = 0.0f;
-        size_t bestCandidate = 0;
-        bool candidateFound = false;
-
-        // Find point with maximum minimum distance to existing centroids
-        for (size_t i = 0; i < objectsMetadata.size(); ++i) {
-            float minDist = std::numeric_limits<float>::max();
-            for (const auto& centroid : centroids) {
-                float dist = calculateDistance(objectsMetadata[i].object.position, centroid);
-                minDist = std::min(minDist, dist);
+        if (bestCandidate < 0 || maxMinDistanceSq < thresholdSq) {
+            break;
+        }
+
+        centroids.push_back(m_seedCandidates.position(bestCandidate));
+        bestCandidate = DistanceKernels::updateFarthestPoint(m_seedCandidates, centroids.back(), m_seedMinDistanceSq.data(), maxMinDistanceSq);
+    }
+
+    assignNewClusterIds();
+}
+
+void KMeans::sampleCoreset() {
+    const AkUInt32 numPoints = m_points.size();
+
+    // Lightweight coreset: half the probability mass is uniform, half proportional to the
+    // squared distance to the mean, so both dense regions and outlying groups get samples
+    m_coresetCdf.resize(numPoints);
+    double totalDistanceSq = 0.0;
+    for (AkUInt32 i = 0; i < numPoints; ++i) {
+        totalDistanceSq += m_utilities.GetDistanceSquared(m_points.position(i), m_pointsMean);
+        m_coresetCdf[i] = totalDistanceSq;
+    }
+
+    // Reseeded on every call so the same objects always give the same sample
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    m_coresetSamples.clear();
+    for (unsigned int s = 0; s < m_coresetSize; ++s) {
+        AkUInt32 index;
+        if (totalDistanceSq <= 0.0 || unit(rng) < 0.5) {
+            index = std::min(static_cast<AkUInt32>(unit(rng) * numPoints), numPoints - 1);
+        }
+        else {
+            const double target = unit(rng) * totalDistanceSq;
+            index = static_cast<AkUInt32>(std::upper_bound(m_coresetCdf.begin(), m_coresetCdf.end(), target) - m_coresetCdf.begin());
+            index = std::min(index, numPoints - 1);
+        }
+        m_coresetSamples.push_back(index);
+    }
+
+    // Merge repeated draws; each draw contributes 1 / (m q(x)) to the object's weight
+    std::sort(m_coresetSamples.begin(), m_coresetSamples.end());
+    m_coresetPoints.resize(0);
+    m_coresetWeights.clear();
+
+    AkUInt32 numUnique = 0;
+    for (size_t s = 0; s < m_coresetSamples.size(); ++s) {
+        const AkUInt32 index = m_coresetSamples[s];
+        const double distanceSq = m_coresetCdf[index] - (index > 0 ? m_coresetCdf[index - 1] : 0.0);
+        const double probability = 0.5 / numPoints + (totalDistanceSq > 0.0 ? 0.5 * distanceSq / totalDistanceSq : 0.5 / numPoints);
+        const float weight = static_cast<float>(1.0 / (m_coresetSize * probability));
+
+        if (s > 0 && m_coresetSamples[s - 1] == index) {
+            m_coresetWeights.back() += weight;
+            continue;
+        }
+
+        m_coresetPoints.resize(numUnique + 1);
+        m_coresetPoints.set(numUnique, m_points.position(index), m_points.key(index));
+        m_coresetWeights.push_back(weight);
+        ++numUnique;
+    }
+}
+
+bool KMeans::runMiniBatches(unsigned int maxBatches) {
+    const AkUInt32 numPoints = m_points.size();
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
+
+    // Reseeded on every run so the same objects always give the same batches
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<AkUInt32> pick(0, numPoints - 1);
+
+    m_batchCounts.assign(centroids.size(), 0);
+    m_batchNearest.resize(m_miniBatchSize);
+    bool outOfTime = false;
+
+    // Past one object count worth of samples, full iterations would have been cheaper
+    const unsigned int numBatches = std::min(maxBatches, (numPoints + m_miniBatchSize - 1) / m_miniBatchSize);
+
+    for (unsigned int batch = 0; batch < numBatches; ++batch) {
+        m_batchSamples.clear();
+        for (unsigned int s = 0; s < m_miniBatchSize; ++s) {
+            m_batchSamples.push_back(pick(rng));
+        }
+
+        // Label the whole batch before moving anything
+        refreshCentroidTree();
+        m_unassigned.clear();
+        for (unsigned int s = 0; s < m_miniBatchSize; ++s) {
+            int nearest;
+            float distanceSq;
+            float secondDistanceSq;
+            findNearestCentroid(m_batchSamples[s], nearest, distanceSq, secondDistanceSq);
+
+            if (nearest >= 0 && distanceSq <= thresholdSq) {
+                m_batchNearest[s] = nearest;
+            }
+            else {
+                m_batchNearest[s] = -1;
+                m_unassigned.push_back(m_batchSamples[s]);
             }
+        }
 
-            if (minDist > maxMinDistance) {
-                maxMinDistance = minDist;
-                bestCandidate = i;
-                candidateFound = true;
+        m_previousIterationCentroids.assign(centroids.begin(), centroids.end());
+        for (unsigned int s = 0; s < m_miniBatchSize; ++s) {
+            const int nearest = m_batchNearest[s];
+            if (nearest < 0) continue;
+
+            const AkVector position = m_points.position(m_batchSamples[s]);
+            const float rate = 1.0f / static_cast<float>(++m_batchCounts[nearest]);
+            AkVector& centroid = centroids[nearest];
+            centroid.X += rate * (position.X - centroid.X);
+            centroid.Y += rate * (position.Y - centroid.Y);
+            centroid.Z += rate * (position.Z - centroid.Z);
+        }
+
+        float maxShift = 0.0f;
+        for (size_t k = 0; k < m_previousIterationCentroids.size(); ++k) {
+            maxShift = std::max(maxShift, calculateDistance(centroids[k], m_previousIterationCentroids[k]));
+        }
+
+        // Out of reach samples start new centroids at the mean of their leader group. Like a full
+        // iteration, a group needs two objects; samples are drawn with replacement, so a group
+        // of one object drawn twice does not count
+        bool grew = false;
+        while (!m_unassigned.empty() && centroids.size() < maxClusters) {
+            extractLeaderCluster(m_unassigned, m_leaderMembers);
+
+            const AkUInt32 leader = m_leaderMembers[0];
+            if (std::all_of(m_leaderMembers.begin(), m_leaderMembers.end(), [leader](AkUInt32 member) { return member == leader; })) {
+                continue;
             }
+
+            AkVector mean{ 0, 0, 0 };
+            for (AkUInt32 member : m_leaderMembers) {
+                const AkVector position = m_points.position(member);
+                mean.X += position.X;
+                mean.Y += position.Y;
+                mean.Z += position.Z;
+            }
+            const float invCount = 1.0f / static_cast<float>(m_leaderMembers.size());
+            centroids.push_back(AkVector{ mean.X * invCount, mean.Y * invCount, mean.Z * invCount });
+            m_batchCounts.push_back(static_cast<AkUInt32>(m_leaderMembers.size()));
+            m_clusterIds.push_back(m_nextClusterId++);
+            grew = true;
         }
 
-        if (!candidateFound || maxMinDistance < m_distanceThreshold) {
+        if (!grew && maxShift <= m_tolerance) {
+            break;
+        }
+        if (budgetExhausted()) {
+            outOfTime = true;
             break;
         }
-
-        centroids.push_back(objectsMetadata[bestCandidate].object.position);
     }
+
+    // The full assignment that follows has no valid bounds for the moved centroids
+    m_boundsValid = false;
+    return outOfTime;
 }
 
 float KMeans::calculateDistance(const AkVector& a, const AkVector& b) const {
     return std::sqrt((a.X - b.X) * (a.X - b.X) + (a.Y - b.Y) * (a.Y - b.Y) + (a.Z - b.Z) * (a.Z - b.Z));
 }
 
-bool KMeans::assignPointsToClusters(const std::vector<ObjectPosition>& objects) {
-    if (objects.empty()) return false;
+bool KMeans::assignPointsToClusters() {
+    if (m_points.empty()) return false;
 
+    const AkUInt32 numObjects = m_points.size();
+    const size_t numCentroids = centroids.size();
     bool changed = false;
-    std::vector<std::vector<ObjectPosition>> newClusters(centroids.size());
-    unassignedPoints.clear();
-
-    // Assign points to nearest centroid if within threshold
-    for (const auto& obj : objects) {
-        float minDistance = std::numeric_limits<float>::max();
-        int closestCentroid = -1;
-
-        // Find closest centroid
-        for (size_t j = 0; j < centroids.size(); ++j) {
-            float distance = calculateDistance(obj.position, centroids[j]);
-            if (distance < minDistance) {
-                minDistance = distance;
-                closestCentroid = j;
-            }
-        }
 
-        // If closest centroid is within threshold, assign to cluster
-        if (closestCentroid >= 0 && minDistance <= m_distanceThreshold) {
-            newClusters[closestCentroid].push_back(obj);
-            if (labels[&obj - &objects[0]] != closestCentroid) {
-                labels[&obj - &objects[0]] = closestCentroid;
-                changed = true;
-            }
+    m_upperBounds.resize(numObjects);
+    m_lowerBounds.resize(numObjects);
+
+    // Without bounds, or when most objects missed their bounds in the last bounded sweep, the
+    // vectorized sweep over all objects is cheaper than searching object by object. A full sweep
+    // resets the miss count so the next iteration tries the bounds again.
+    const bool fullSweep = !m_boundsValid || m_boundMissCount * 4 > numObjects;
+
+    // With many centroids, searching a tree per object beats scanning all of them
+    refreshCentroidTree();
+    const bool useKernel = fullSweep && !m_useCentroidTree;
+
+    if (useKernel) {
+        m_nearest.resize(m_points.paddedSize());
+        m_nearestDistanceSq.resize(m_points.paddedSize());
+        m_secondDistanceSq.resize(m_points.paddedSize());
+    }
+    if (!fullSweep) {
+        updateCentroidSeparation();
+    }
+
+    // Each chunk carries the bounds over the last centroid update, skips every object whose bounds
+    // prove that its assignment cannot change, searches the others, and accumulates its sums
+    const AkUInt32 numChunks = (numObjects + kAssignChunkSize - 1) / kAssignChunkSize;
+    if (m_assignChunks.size() < numChunks) {
+        m_assignChunks.resize(numChunks);
+    }
+    auto runChunk = [this, fullSweep, useKernel](AkUInt32 chunk) { assignChunk(chunk, fullSweep, useKernel); };
+    if (m_pool) {
+        // The pool serves the earliest deadline first, which is the end of the time budget if there is one
+        const WorkerPool::Clock::time_point deadline = m_timeBudgetUs > 0
+            ? m_runStart + std::chrono::microseconds(m_timeBudgetUs)
+            : WorkerPool::Clock::time_point::max();
+        m_pool->parallelFor(numChunks, runChunk, m_threadCount, deadline);
+    }
+    else {
+        for (AkUInt32 chunk = 0; chunk < numChunks; ++chunk) {
+            runChunk(chunk);
         }
-        else {
-            // Point is too far from any existing cluster
-            unassignedPoints.push_back(obj);
-            labels[&obj - &objects[0]] = -1;
-            changed = true;
+    }
+    m_boundsPending = false;
+
+    // Combine the chunks in order, so the sums are the same whichever thread ran each chunk
+    m_clusterCounts.assign(numCentroids, 0);
+    m_clusterSums.assign(numCentroids, AkVector{ 0, 0, 0 });
+    m_clusterSumSq.assign(numCentroids, 0.0);
+    m_unassigned.clear();
+    m_boundMissCount = 0;
+    for (AkUInt32 chunk = 0; chunk < numChunks; ++chunk) {
+        const AssignChunk& part = m_assignChunks[chunk];
+        for (size_t k = 0; k < numCentroids; ++k) {
+            m_clusterCounts[k] += part.counts[k];
+            m_clusterSums[k].X += part.sums[k].X;
+            m_clusterSums[k].Y += part.sums[k].Y;
+            m_clusterSums[k].Z += part.sums[k].Z;
+            m_clusterSumSq[k] += part.sumSq[k];
         }
+        m_unassigned.insert(m_unassigned.end(), part.unassigned.begin(), part.unassigned.end());
+        m_boundMissCount += part.boundMissCount;
+        changed = changed || part.changed;
     }
 
-    // Remove empty clusters
-    auto it = std::remove_if(newClusters.begin(), newClusters.end(),
-        [](const std::vector<ObjectPosition>& cluster) { return cluster.empty(); });
-    newClusters.erase(it, newClusters.end());
+    // Remove empty clusters, remembering which centroid each remaining cluster came from
+    removeEmptyClusters();
 
     // Form new clusters from unassigned points if they're close to each other
-    while (!unassignedPoints.empty()) {
-        std::vector<ObjectPosition> newCluster;
-        newCluster.push_back(unassignedPoints[0]);
-        AkVector clusterCenter = unassignedPoints[0].position;
-
-        // Find all points within m_distanceThreshold of the first point
-        // No increment in loop control: when we remove a point, next point slides into current position
-        for (size_t i = 1; i < unassignedPoints.size();) {
-            if (calculateDistance(unassignedPoints[i].position, clusterCenter) <= m_distanceThreshold) {
-                newCluster.push_back(unassignedPoints[i]);
-                unassignedPoints.erase(unassignedPoints.begin() + i);
+    if (formLeaderClusters()) {
+        changed = true;
+    }
+
+    // Update centroids
+    m_previousIterationCentroids.swap(centroids);
+    centroids.clear();
+    for (size_t k = 0; k < m_clusterCounts.size(); ++k) {
+        centroids.push_back(calculateCentroid(k));
+    }
+
+    updateBounds();
+    return changed;
+}
+
+void KMeans::assignChunk(AkUInt32 chunk, bool fullSweep, bool useKernel) {
+    const size_t numCentroids = centroids.size();
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
+    const AkUInt32 begin = chunk * kAssignChunkSize;
+    const AkUInt32 end = std::min(begin + kAssignChunkSize, m_points.size());
+
+    AssignChunk& part = m_assignChunks[chunk];
+    part.counts.assign(numCentroids, 0);
+    part.sums.assign(numCentroids, AkVector{ 0, 0, 0 });
+    part.sumSq.assign(numCentroids, 0.0);
+    part.unassigned.clear();
+    part.boundMissCount = 0;
+    part.changed = false;
+
+    if (useKernel) {
+        // Chunks start on a kernel block, the last one also covers the padding
+        const AkUInt32 kernelEnd = std::min(begin + kAssignChunkSize, m_points.paddedSize());
+        DistanceKernels::findNearestCentroids(m_points, centroids.data(), static_cast<AkUInt32>(numCentroids),
+            m_nearest.data(), m_nearestDistanceSq.data(), m_secondDistanceSq.data(), begin, kernelEnd);
+    }
+
+    for (AkUInt32 i = begin; i < end; ++i) {
+        const AkVector position{ m_points.x()[i], m_points.y()[i], m_points.z()[i] };
+        bool miss = true;
+
+        if (!fullSweep) {
+            const int assigned = labels[i];
+            if (m_boundsPending) {
+                carryBounds(i, position);
+            }
+
+            if (assigned < 0) {
+                // Still farther than the threshold from every centroid
+                miss = m_lowerBounds[i] <= m_distanceThreshold;
             }
             else {
-                ++i;
+                const float bound = std::max(m_halfSeparation[assigned], m_lowerBounds[i]);
+                if (m_upperBounds[i] <= bound && m_upperBounds[i] <= m_distanceThreshold) {
+                    miss = false;
+                }
+                else {
+                    // Tighten the upper bound to the exact distance and test again
+                    m_upperBounds[i] = std::sqrt(m_utilities.GetDistanceSquared(position, centroids[assigned]));
+                    if (m_upperBounds[i] <= bound) {
+                        miss = false;
+                        if (m_upperBounds[i] > m_distanceThreshold) {
+                            // Still the nearest centroid, but now out of reach
+                            m_lowerBounds[i] = m_upperBounds[i];
+                            labels[i] = -1;
+                        }
+                    }
+                }
             }
         }
-        unassignedPoints.erase(unassignedPoints.begin());
 
-        if (newCluster.size() > 1) {
-            newClusters.push_back(std::move(newCluster));
-            changed = true;
+        if (miss) {
+            if (!fullSweep) {
+                ++part.boundMissCount;
+            }
+
+            int closestCentroid;
+            float distanceSq;
+            float secondDistanceSq;
+            if (useKernel) {
+                closestCentroid = m_nearest[i];
+                distanceSq = m_nearestDistanceSq[i];
+                secondDistanceSq = m_secondDistanceSq[i];
+            }
+            else {
+                findNearestCentroid(i, closestCentroid, distanceSq, secondDistanceSq);
+            }
+
+            // Assign the point to its nearest centroid if within threshold
+            if (closestCentroid >= 0 && distanceSq <= thresholdSq) {
+                m_upperBounds[i] = std::sqrt(distanceSq);
+                m_lowerBounds[i] = std::sqrt(secondDistanceSq);
+                if (labels[i] != closestCentroid) {
+                    labels[i] = closestCentroid;
+                    part.changed = true;
+                }
+            }
+            else {
+                // Point is too far from any existing cluster
+                m_lowerBounds[i] = std::sqrt(distanceSq);
+                labels[i] = -1;
+            }
+        }
+
+        const int assigned = labels[i];
+        if (assigned >= 0) {
+            part.counts[assigned]++;
+            part.sums[assigned].X += position.X;
+            part.sums[assigned].Y += position.Y;
+            part.sums[assigned].Z += position.Z;
+            part.sumSq[assigned] += static_cast<double>(position.X) * position.X
+                + static_cast<double>(position.Y) * position.Y
+                + static_cast<double>(position.Z) * position.Z;
+        }
+        else {
+            part.unassigned.push_back(i);
+            part.changed = true;
         }
     }
+}
 
-    // Update centroids
-    centroids.clear();
-    for (const auto& cluster : newClusters) {
-        centroids.push_back(calculateCentroid(cluster));
+void KMeans::refreshCentroidTree() {
+    m_useCentroidTree = centroids.size() >= kCentroidTreeMinClusters;
+    if (m_useCentroidTree) {
+        m_centroidTree.build(centroids.data(), static_cast<AkUInt32>(centroids.size()));
+    }
+}
+
+void KMeans::findNearestCentroid(AkUInt32 index, int& outNearest, float& outDistanceSq, float& outSecondDistanceSq) const {
+    const AkVector position = m_points.position(index);
+
+    if (m_useCentroidTree) {
+        // Anything past twice the threshold is only needed as a lower bound, which the radius provides
+        m_centroidTree.findNearestTwo(position, 2.0f * m_distanceThreshold, outNearest, outDistanceSq, outSecondDistanceSq);
+        return;
     }
 
-    clusters = std::move(newClusters);
-    return changed;
+    outNearest = -1;
+    outDistanceSq = std::numeric_limits<float>::max();
+    outSecondDistanceSq = std::numeric_limits<float>::max();
+
+    for (size_t j = 0; j < centroids.size(); ++j) {
+        const float distSq = m_utilities.GetDistanceSquared(position, centroids[j]);
+        if (distSq < outDistanceSq) {
+            outSecondDistanceSq = outDistanceSq;
+            outDistanceSq = distSq;
+            outNearest = static_cast<int>(j);
+        }
+        else if (distSq < outSecondDistanceSq) {
+            outSecondDistanceSq = distSq;
+        }
+    }
 }
 
-void KMeans::adjustClusterCount() {
-    // Remove empty clusters
-    auto it = std::remove_if(clusters.begin(), clusters.end(),
-        [](const std::vector<ObjectPosition>& cluster) { return cluster.empty(); });
-    clusters.erase(it, clusters.end());
+void KMeans::updateCentroidSeparation() {
+    const size_t numCentroids = centroids.size();
+
+    if (m_useCentroidTree) {
+        m_halfSeparation.resize(numCentroids);
+
+        // The bound test also needs the upper bound within the threshold, so half separations
+        // beyond it prove nothing more and the search can stop at twice the threshold
+        for (size_t a = 0; a < numCentroids; ++a) {
+            int nearest;
+            float distanceSq;
+            float secondDistanceSq;
+            m_centroidTree.findNearestTwo(centroids[a], 2.0f * m_distanceThreshold, nearest, distanceSq, secondDistanceSq);
+            m_halfSeparation[a] = 0.5f * std::sqrt(secondDistanceSq);
+        }
+        return;
+    }
+
+    m_halfSeparation.assign(numCentroids, std::numeric_limits<float>::max());
+
+    for (size_t a = 0; a < numCentroids; ++a) {
+        for (size_t b = a + 1; b < numCentroids; ++b) {
+            const float half = 0.5f * std::sqrt(m_utilities.GetDistanceSquared(centroids[a], centroids[b]));
+            m_halfSeparation[a] = std::min(m_halfSeparation[a], half);
+            m_halfSeparation[b] = std::min(m_halfSeparation[b], half);
+        }
+    }
+}
+
+void KMeans::updateBounds() {
+    const size_t numClusters = centroids.size();
+    m_centroidShift.assign(numClusters, 0.0f);
+    m_newClusters.clear();
+
+    // Clusters formed from unassigned points are appended after the ones kept from the last centroids
+    m_maxCentroidShift = 0.0f;
+    m_firstNewCluster = static_cast<int>(numClusters);
+    for (size_t k = 0; k < numClusters; ++k) {
+        if (m_clusterOrigin[k] >= 0) {
+            m_centroidShift[k] = std::sqrt(m_utilities.GetDistanceSquared(centroids[k], m_previousIterationCentroids[m_clusterOrigin[k]]));
+            m_maxCentroidShift = std::max(m_maxCentroidShift, m_centroidShift[k]);
+        }
+        else {
+            m_firstNewCluster = std::min(m_firstNewCluster, static_cast<int>(k));
+            m_newClusters.push_back(static_cast<AkUInt32>(k));
+        }
+    }
+
+    // The per-object part is applied by carryBounds during the next assignment sweep
+    m_boundsValid = true;
+    m_boundsPending = true;
+}
+
+void KMeans::carryBounds(AkUInt32 index, const AkVector& position) {
+    const int assigned = labels[index];
+
+    // Members of a brand new cluster have no history, measure them directly
+    if (assigned >= m_firstNewCluster) {
+        m_upperBounds[index] = std::sqrt(m_utilities.GetDistanceSquared(position, centroids[assigned]));
+        m_lowerBounds[index] = 0.0f;
+        return;
+    }
+
+    if (assigned >= 0) {
+        m_upperBounds[index] += m_centroidShift[assigned];
+    }
+    m_lowerBounds[index] = std::max(0.0f, m_lowerBounds[index] - m_maxCentroidShift);
+
+    // New centroids can only pull the lower bound down
+    for (AkUInt32 n : m_newClusters) {
+        if (assigned >= 0) {
+            // |x - n| >= |a - n| - |x - a| >= |a - n| - upper
+            const float separation = std::sqrt(m_utilities.GetDistanceSquared(centroids[assigned], centroids[n]));
+            m_lowerBounds[index] = std::max(0.0f, std::min(m_lowerBounds[index], separation - m_upperBounds[index]));
+        }
+        else {
+            m_lowerBounds[index] = std::min(m_lowerBounds[index], std::sqrt(m_utilities.GetDistanceSquared(position, centroids[n])));
+        }
+    }
+}
 
-    // Remove corresponding centroids
-    centroids.resize(clusters.size());
+void KMeans::adjustClusterCount() {
+    // Remove empty clusters and their centroids, keeping the order of the others
+    if (removeEmptyClusters()) {
+        for (size_t k = 0; k < m_clusterOrigin.size(); ++k) {
+            centroids[k] = centroids[m_clusterOrigin[k]];
+        }
+        m_boundsValid = false;
+    }
+    centroids.resize(m_clusterCounts.size());
 
     // Try to create new clusters from unassigned points
-    while (!unassignedPoints.empty() && clusters.size() < maxClusters) {
-        AkVector newCentroid = unassignedPoints[0].position;
-        std::vector<ObjectPosition> newCluster;
-
-        auto unassignedIt = unassignedPoints.begin();
-        while (unassignedIt != unassignedPoints.end()) {
-            if (calculateDistance(unassignedIt->position, newCentroid) <= m_distanceThreshold) {
-                newCluster.push_back(*unassignedIt);
-                unassignedIt = unassignedPoints.erase(unassignedIt);
-            }
-            else {
-                ++unassignedIt;
+    while (!m_unassigned.empty() && m_clusterCounts.size() < maxClusters) {
+        AkVector newCentroid = m_points.position(m_unassigned[0]);
+        extractLeaderCluster(m_unassigned, m_leaderMembers);
+
+        for (AkUInt32 member : m_leaderMembers) {
+            labels[member] = static_cast<int>(m_clusterCounts.size());
+        }
+        appendCluster(m_leaderMembers);
+
+        centroids.push_back(newCentroid);
+        m_boundsValid = false;
+    }
+}
+
+void KMeans::appendCluster(const std::vector<AkUInt32>& members) {
+    AkVector sum{ 0, 0, 0 };
+    double sumSq = 0.0;
+    for (AkUInt32 member : members) {
+        const float x = m_points.x()[member];
+        const float y = m_points.y()[member];
+        const float z = m_points.z()[member];
+        sum.X += x;
+        sum.Y += y;
+        sum.Z += z;
+        sumSq += static_cast<double>(x) * x + static_cast<double>(y) * y + static_cast<double>(z) * z;
+    }
+    m_clusterSums.push_back(sum);
+    m_clusterSumSq.push_back(sumSq);
+    m_clusterCounts.push_back(static_cast<AkUInt32>(members.size()));
+    m_clusterIds.push_back(m_nextClusterId++);
+}
+
+void KMeans::assignNewClusterIds() {
+    m_clusterIds.resize(centroids.size());
+    for (auto& id : m_clusterIds) {
+        id = m_nextClusterId++;
+    }
+}
+
+void KMeans::fillResult() {
+    m_result.clear();
+    for (size_t k = 0; k < m_clusterCounts.size(); ++k) {
+        if (m_clusterCounts[k] == 0) continue;
+
+        m_result.addCluster(m_clusterIds[k], calculateCentroid(k));
+        for (AkUInt32 m = m_clusterOffsets[k]; m < m_clusterOffsets[k + 1]; ++m) {
+            m_result.addMember(m_points.key(m_clusterMembers[m]));
+        }
+    }
+    m_result.finalize();
+}
+
+bool KMeans::removeEmptyClusters() {
+    const size_t numClusters = m_clusterCounts.size();
+    m_clusterOrigin.clear();
+    m_clusterRemap.assign(numClusters, -1);
+
+    size_t numKept = 0;
+    for (size_t c = 0; c < numClusters; ++c) {
+        if (m_clusterCounts[c] == 0) continue;
+
+        m_clusterRemap[c] = static_cast<int>(numKept);
+        m_clusterOrigin.push_back(static_cast<int>(c));
+        m_clusterCounts[numKept] = m_clusterCounts[c];
+        m_clusterSums[numKept] = m_clusterSums[c];
+        m_clusterSumSq[numKept] = m_clusterSumSq[c];
+        m_clusterIds[numKept] = m_clusterIds[c];
+        ++numKept;
+    }
+
+    if (numKept == numClusters) {
+        return false;
+    }
+
+    m_clusterCounts.resize(numKept);
+    m_clusterSums.resize(numKept);
+    m_clusterSumSq.resize(numKept);
+    m_clusterIds.resize(numKept);
+    for (AkUInt32 i = 0; i < m_points.size(); ++i) {
+        if (labels[i] >= 0) {
+            labels[i] = m_clusterRemap[labels[i]];
+        }
+    }
+    return true;
+}
+
+void KMeans::buildClusterMembership() {
+    const size_t numClusters = m_clusterCounts.size();
+    m_clusterOffsets.resize(numClusters + 1);
+    m_clusterOffsets[0] = 0;
+    for (size_t k = 0; k < numClusters; ++k) {
+        m_clusterOffsets[k + 1] = m_clusterOffsets[k] + m_clusterCounts[k];
+    }
+
+    // Counting sort by label; scanning the objects in order keeps each cluster's members ascending
+    m_clusterMembers.resize(m_clusterOffsets[numClusters]);
+    m_clusterCursor.assign(m_clusterOffsets.begin(), m_clusterOffsets.end() - 1);
+    for (AkUInt32 i = 0; i < m_points.size(); ++i) {
+        if (labels[i] >= 0) {
+            m_clusterMembers[m_clusterCursor[labels[i]]++] = i;
+        }
+    }
+}
+
+bool KMeans::formLeaderClusters() {
+    bool formed = false;
+    while (!m_unassigned.empty()) {
+        extractLeaderCluster(m_unassigned, m_leaderMembers);
+
+        if (m_leaderMembers.size() > 1) {
+            for (AkUInt32 member : m_leaderMembers) {
+                labels[member] = static_cast<int>(m_clusterCounts.size());
             }
+            appendCluster(m_leaderMembers);
+            m_clusterOrigin.push_back(-1);
+            formed = true;
         }
+    }
+    return formed;
+}
 
-        if (!newCluster.empty()) {
-            clusters.push_back(std::move(newCluster));
-            centroids.push_back(newCentroid);
+void KMeans::extractLeaderCluster(std::vector<AkUInt32>& remaining, std::vector<AkUInt32>& outMembers) const {
+    outMembers.clear();
+    if (remaining.empty()) return;
+
+    const AkUInt32 leader = remaining[0];
+    const AkVector leaderPosition = m_points.position(leader);
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
+    outMembers.push_back(leader);
+
+    // Single sweep: members move out, everything else is compacted towards the front in its original order
+    size_t write = 0;
+    for (size_t read = 1; read < remaining.size(); ++read) {
+        const AkUInt32 candidate = remaining[read];
+        if (m_utilities.GetDistanceSquared(m_points.position(candidate), leaderPosition) <= thresholdSq) {
+            outMembers.push_back(candidate);
         }
         else {
-            break;  // No more clusters can be formed
+            remaining[write++] = candidate;
         }
     }
+    remaining.resize(write);
 }
 
 float KMeans::calculateGaussianWeight(float distanceSquared, float radiusSquared) const
 {
-    return std::exp(-distanceSquared / (2.0f * radiusSquared));
+    const float t = distanceSquared / radiusSquared;
+
+    // The table only covers the inside of the radius, anything else (including NaN) takes the exact path
+    if (!(t < 1.0f)) {
+        return std::exp(-0.5f * t);
+    }
+
+    const float scaled = t * kGaussianTableSize;
+    const unsigned int index = static_cast<unsigned int>(scaled);
+    const float fraction = scaled - static_cast<float>(index);
+    return m_gaussianTable[index] + (m_gaussianTable[index + 1] - m_gaussianTable[index]) * fraction;
 }
 
 void KMeans::setMinDistanceThreshold(float newValue)
@@ -268,17 +798,16 @@ void KMeans::setMaxDistanceThreshold(float newValue)
 }
 
 bool KMeans::updateCentroids() {
-    if (clusters.empty()) return false;
+    if (m_clusterCounts.empty()) return false;
 
     bool changed = false;
-    std::vector<AkVector> newCentroids;
-    newCentroids.reserve(clusters.size());
+    std::vector<AkVector>& newCentroids = m_updatedCentroids;
+    newCentroids.clear();
 
-    for (const auto& cluster : clusters) {
-        if (cluster.empty()) continue;
+    for (size_t k = 0; k < m_clusterCounts.size(); ++k) {
+        if (m_clusterCounts[k] == 0) continue;
 
-        AkVector newCentroid = calculateCentroid(cluster);
-        newCentroids.push_back(newCentroid);
+        newCentroids.push_back(calculateCentroid(k));
     }
 
     // Check if any centroids moved significantly
@@ -290,7 +819,8 @@ bool KMeans::updateCentroids() {
     }
 
     if (changed) {
-        centroids = std::move(newCentroids);
+        centroids.swap(newCentroids);
+        m_boundsValid = false;
     }
 
     return changed;
@@ -305,29 +835,32 @@ void KMeans::adjustClusterCount(unsigned int numObjects) {
 }
 
 float KMeans::calculateSSE() const {
-    float sse = 0.0f;
-    for (size_t i = 0; i < clusters.size(); ++i) {
-        for (const auto& obj : clusters[i]) {
-            float distance = calculateDistance(obj.position, centroids[i]);
-            sse += distance * distance;  // Still square here as SSE is defined with squared distances
-        }
+    // sum |x - c|^2 = sum |x|^2 - 2 c . sum x + n |c|^2, so the per-cluster sums are enough
+    double sse = 0.0;
+    for (size_t i = 0; i < m_clusterCounts.size(); ++i) {
+        if (m_clusterCounts[i] == 0) continue;
+
+        const double cx = centroids[i].X, cy = centroids[i].Y, cz = centroids[i].Z;
+        const AkVector& sum = m_clusterSums[i];
+        const double clusterSSE = m_clusterSumSq[i]
+            - 2.0 * (cx * sum.X + cy * sum.Y + cz * sum.Z)
+            + m_clusterCounts[i] * (cx * cx + cy * cy + cz * cz);
+
+        // Rounding can push a tight cluster slightly below zero
+        sse += std::max(0.0, clusterSSE);
     }
-    return sse;
+    return static_cast<float>(sse);
 }
 
-AkVector KMeans::calculateCentroid(const std::vector<ObjectPosition>& cluster)
+AkVector KMeans::calculateCentroid(size_t cluster) const
 {
     AkVector centroid = { 0, 0, 0 };
-    if (cluster.empty()) return centroid;
+    const AkUInt32 count = m_clusterCounts[cluster];
+    if (count == 0) return centroid;
 
-    for (const auto& obj : cluster) {
-        centroid.X += obj.position.X;
-        centroid.Y += obj.position.Y;
-        centroid.Z += obj.position.Z;
-    }
-    centroid.X /= cluster.size();
-    centroid.Y /= cluster.size();
-    centroid.Z /= cluster.size();
+    centroid.X = m_clusterSums[cluster].X / count;
+    centroid.Y = m_clusterSums[cluster].Y / count;
+    centroid.Z = m_clusterSums[cluster].Z / count;
 
     return centroid;
 }
@@ -338,8 +871,11 @@ KMeans::KMeans(float tolerance, float distanceThreshold, float minDistanceThresh
     m_minThreshold(minDistanceThreshold),
     m_maxThreshold(maxDistanceThreshold)
 {
-    std::random_device rd;
-    seed = rd();
+    seed = kDefaultSeed;
+
+    for (unsigned int i = 0; i <= kGaussianTableSize; ++i) {
+        m_gaussianTable[i] = std::exp(-0.5f * static_cast<float>(i) / kGaussianTableSize);
+    }
 }
 
 void KMeans::setTolerance(float newValue) {
@@ -350,61 +886,413 @@ void KMeans::setDistanceThreshold(float newValue) {
     m_distanceThreshold = clamp(newValue, m_minThreshold, m_maxThreshold);
 }
 
-void KMeans::performClustering(const std::vector<ObjectPosition>& objects, unsigned int max_iterations) {
-    labels.resize(objects.size(), -1);
-    maxClusters = determineMaxClusters(objects.size());
-    initializeCentroids(objects);
+void KMeans::configure(const ClusteringSettings& settings) {
+    setDistanceThreshold(settings.distanceThreshold);
+    setWarmStart(settings.warmStart);
+    setCoresetSize(settings.coresetSize);
+    setMiniBatchSize(settings.miniBatchSize);
+    setTimeBudget(settings.timeBudgetUs);
+    setThreadCount(settings.threadCount);
+    setIncrementalUpdates(settings.movementEpsilon, settings.maxChangedFraction);
+    setHysteresisMargin(settings.hysteresisMargin);
+}
 
-    for (unsigned int iter = 0; iter < max_iterations; ++iter) {
+void KMeans::setWarmStart(bool enabled) {
+    m_warmStart = enabled;
+}
 
-        bool changed = assignPointsToClusters(objects);
-        adjustClusterCount();
-        bool centroidsUpdated = updateCentroids();
+void KMeans::setCoresetSize(unsigned int size) {
+    m_coresetSize = size;
+}
 
-        float current_sse = calculateSSE();
-        sse_values.push_back(current_sse);
+void KMeans::setSeed(unsigned int newSeed) {
+    seed = newSeed;
+}
 
-        // Check for convergence
-        if ((!changed && !centroidsUpdated) ||
-            (iter > 0 && std::abs(sse_values[iter] - sse_values[iter - 1]) < m_tolerance * sse_values[iter - 1])) {
-            break;
-        }
+void KMeans::setMiniBatchSize(unsigned int size) {
+    m_miniBatchSize = size;
+}
+
+void KMeans::setTimeBudget(AkUInt32 microseconds) {
+    m_timeBudgetUs = microseconds;
+}
+
+void KMeans::setIncrementalUpdates(float movementEpsilon, float maxChangedFraction) {
+    m_movementEpsilon = std::max(movementEpsilon, 0.0f);
+    m_maxChangedFraction = clamp(maxChangedFraction, 0.0f, 1.0f);
+}
+
+void KMeans::setHysteresisMargin(float margin) {
+    m_hysteresisMargin = std::max(margin, 0.0f);
+}
+
+void KMeans::setThreadCount(unsigned int count) {
+    m_threadCount = clamp(count, 1u, WorkerPool::kMaxThreads);
+    if (m_threadCount == 1) {
+        m_pool.reset();
+        return;
     }
 
-    adjustClusterCount();
+    if (!m_pool) {
+        m_pool = WorkerPool::acquireShared();
+    }
+    // Called on the audio thread, so the pool grows in the background. Until then, or if it
+    // can't, the sweep runs on the threads it has, with the same result.
+    m_pool->requestThreads(m_threadCount);
 }
 
-const std::vector<int>& KMeans::getLabels() const {
-    return labels;
+bool KMeans::budgetExhausted() const {
+    if (m_timeBudgetUs == 0) return false;
+
+    const auto elapsed = std::chrono::steady_clock::now() - m_runStart;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count() >= m_timeBudgetUs;
 }
 
-const std::vector<AkVector>& KMeans::getCentroids() const {
-    return centroids;
+float KMeans::calculateSpread(AkVector& mean) const {
+    const AkUInt32 numPoints = m_points.size();
+    mean = AkVector{ 0, 0, 0 };
+    if (numPoints == 0) return 0.0f;
+
+    for (AkUInt32 i = 0; i < numPoints; ++i) {
+        mean.X += m_points.x()[i];
+        mean.Y += m_points.y()[i];
+        mean.Z += m_points.z()[i];
+    }
+    mean.X /= numPoints;
+    mean.Y /= numPoints;
+    mean.Z /= numPoints;
+
+    float sumSq = 0.0f;
+    for (AkUInt32 i = 0; i < numPoints; ++i) {
+        sumSq += m_utilities.GetDistanceSquared(m_points.position(i), mean);
+    }
+    return std::sqrt(sumSq / numPoints);
+}
+
+bool KMeans::canWarmStart(unsigned int numObjects, float spread) const {
+    if ((!m_warmStart && !m_resumePending) || m_previousCentroids.empty() || m_previousThreshold != m_distanceThreshold) {
+        return false;
+    }
+
+    const float countChange = std::abs(static_cast<float>(numObjects) - static_cast<float>(m_previousObjectCount));
+    if (countChange > kWarmStartMaxCountChange * m_previousObjectCount) {
+        return false;
+    }
+
+    // A single object or a tight group has no spread, so measure the change against the threshold instead
+    const float spreadScale = std::max(m_previousSpread, m_distanceThreshold);
+    return std::abs(spread - m_previousSpread) <= kWarmStartMaxSpreadChange * spreadScale;
 }
 
-std::map<AkVector, std::vector<AkAudioObjectID>> KMeans::getClusters() const {
-    std::map<AkVector, std::vector<AkAudioObjectID>> clusterMap;
+void KMeans::performClustering(const ObjectPosition* objects, AkUInt32 numObjects, unsigned int max_iterations) {
+    if (numObjects == 0) {
+        // Nothing to cluster: drop the last run's clusters but keep its state for a warm start
+        m_points.clear();
+        labels.clear();
+        centroids.clear();
+        m_clusterCounts.clear();
+        m_clusterSums.clear();
+        m_clusterSumSq.clear();
+        m_clusterIds.clear();
+        m_clusterOffsets.assign(1, 0);
+        m_clusterMembers.clear();
+        m_result.clear();
+        return;
+    }
+
+    if (updateIncrementally(objects, numObjects)) {
+        return;
+    }
+
+    m_runStart = std::chrono::steady_clock::now();
+    bool outOfTime = false;
+    m_changesSinceFullRun = 0;
+
+    labels.resize(numObjects, -1);
+    m_points.assign(objects, numObjects);
+    maxClusters = determineMaxClusters(numObjects);
+    sse_values.clear();
+    m_boundsValid = false;
 
-    for (const auto& cluster : clusters) {
-        if (!cluster.empty()) {
-            AkVector centroid = { 0, 0, 0 };
-            for (const auto& obj : cluster) {
-                centroid.X += obj.position.X;
-                centroid.Y += obj.position.Y;
-                centroid.Z += obj.position.Z;
+    const float spread = calculateSpread(m_pointsMean);
+    if (canWarmStart(numObjects, spread)) {
+        centroids = m_previousCentroids;
+        m_clusterIds = m_previousClusterIds;
+    }
+    else {
+        initializeCentroids();
+    }
+
+    if (m_miniBatchSize > 0 && numObjects > m_miniBatchSize) {
+        // Refine on batches, then label every object once against the refined centroids
+        outOfTime = runMiniBatches(max_iterations);
+        assignPointsToClusters();
+        sse_values.push_back(calculateSSE());
+    }
+    else {
+        for (unsigned int iter = 0; iter < max_iterations; ++iter) {
+
+            bool changed = assignPointsToClusters();
+            adjustClusterCount();
+            bool centroidsUpdated = updateCentroids();
+
+            float current_sse = calculateSSE();
+            sse_values.push_back(current_sse);
+
+            // Check for convergence
+            if ((!changed && !centroidsUpdated) ||
+                (iter > 0 && std::abs(sse_values[iter] - sse_values[iter - 1]) < m_tolerance * sse_values[iter - 1])) {
+                break;
             }
-            centroid.X /= cluster.size();
-            centroid.Y /= cluster.size();
-            centroid.Z /= cluster.size();
 
-            std::vector<AkAudioObjectID> objectIDs;
-            for (const auto& obj : cluster) {
-                objectIDs.push_back(obj.key);
+            // Publish what we have and pick up from here on the next call
+            if (budgetExhausted()) {
+                outOfTime = true;
+                break;
             }
+        }
+    }
+    m_resumePending = outOfTime;
 
-            clusterMap[centroid] = std::move(objectIDs);
+    adjustClusterCount();
+    applyHysteresis(nullptr);
+    buildClusterMembership();
+
+    m_previousCentroids = centroids;
+    m_previousClusterIds = m_clusterIds;
+    m_previousObjectCount = numObjects;
+    m_previousSpread = spread;
+    m_previousThreshold = m_distanceThreshold;
+
+    fillResult();
+}
+
+bool KMeans::updateIncrementally(const ObjectPosition* objects, AkUInt32 numObjects) {
+    if (m_movementEpsilon <= 0.0f || m_points.empty() || m_resumePending || m_previousThreshold != m_distanceThreshold) {
+        return false;
+    }
+
+    const float epsilonSq = m_movementEpsilon * m_movementEpsilon;
+    const AkUInt32 previousCount = m_points.size();
+    const AkUInt32 allowedChanges = static_cast<AkUInt32>(m_maxChangedFraction * numObjects);
+    m_dirtyObjects.clear();
+
+    bool sameObjects = numObjects == previousCount;
+    for (AkUInt32 i = 0; sameObjects && i < numObjects; ++i) {
+        sameObjects = objects[i].key == m_points.key(i);
+    }
+
+    if (sameObjects) {
+        // The common case: same objects in the same order, compare in place
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            if (m_utilities.GetDistanceSquared(objects[i].position, m_points.position(i)) > epsilonSq) {
+                m_dirtyObjects.push_back(i);
+            }
+        }
+        if (m_dirtyObjects.empty()) return true;
+        if (m_changesSinceFullRun + m_dirtyObjects.size() > allowedChanges) return false;
+
+        for (AkUInt32 i : m_dirtyObjects) {
+            removeFromCluster(labels[i], m_points.position(i));
+            m_points.set(i, objects[i].position, objects[i].key);
+        }
+    }
+    else {
+        // Match the objects to the previous ones by key
+        m_previousKeys.resize(previousCount);
+        for (AkUInt32 j = 0; j < previousCount; ++j) {
+            m_previousKeys[j] = { m_points.key(j), j };
+        }
+        std::sort(m_previousKeys.begin(), m_previousKeys.end());
+
+        m_previousIndex.resize(numObjects);
+        m_previousMatched.assign(previousCount, 0);
+        AkUInt32 kept = 0;
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            auto it = std::lower_bound(m_previousKeys.begin(), m_previousKeys.end(), objects[i].key,
+                [](const std::pair<AkAudioObjectID, AkUInt32>& entry, AkAudioObjectID key) { return entry.first < key; });
+            const bool found = it != m_previousKeys.end() && it->first == objects[i].key && !m_previousMatched[it->second];
+            m_previousIndex[i] = found ? static_cast<int>(it->second) : -1;
+            if (found) {
+                m_previousMatched[it->second] = 1;
+                ++kept;
+            }
+            if (!found || m_utilities.GetDistanceSquared(objects[i].position, m_points.position(it->second)) > epsilonSq) {
+                m_dirtyObjects.push_back(i);
+            }
+        }
+
+        const AkUInt32 left = previousCount - kept;
+        if (m_changesSinceFullRun + m_dirtyObjects.size() + left > allowedChanges) return false;
+        m_changesSinceFullRun += left;
+
+        // Take the objects that left or moved out of their clusters
+        for (AkUInt32 j = 0; j < previousCount; ++j) {
+            if (!m_previousMatched[j]) {
+                removeFromCluster(labels[j], m_points.position(j));
+            }
+        }
+        for (AkUInt32 i : m_dirtyObjects) {
+            if (m_previousIndex[i] >= 0) {
+                removeFromCluster(labels[m_previousIndex[i]], m_points.position(m_previousIndex[i]));
+            }
+        }
+
+        // Carry the clean objects over in the new order, with the positions they were assigned with
+        m_updatedPoints.resize(numObjects);
+        m_updatedLabels.resize(numObjects);
+        for (AkUInt32 i = 0; i < numObjects; ++i) {
+            const int previous = m_previousIndex[i];
+            m_updatedPoints.set(i, previous >= 0 ? m_points.position(previous) : objects[i].position, objects[i].key);
+            m_updatedLabels[i] = previous >= 0 ? labels[previous] : -1;
+        }
+        for (AkUInt32 i : m_dirtyObjects) {
+            m_updatedPoints.set(i, objects[i].position, objects[i].key);
+        }
+        std::swap(m_points, m_updatedPoints);
+        labels.swap(m_updatedLabels);
+    }
+    m_changesSinceFullRun += static_cast<AkUInt32>(m_dirtyObjects.size());
+
+    // Reassign the dirty objects against the centroids as they are
+    refreshCentroidTree();
+    const float thresholdSq = m_distanceThreshold * m_distanceThreshold;
+    for (AkUInt32 i : m_dirtyObjects) {
+        int nearest;
+        float distanceSq;
+        float secondDistanceSq;
+        findNearestCentroid(i, nearest, distanceSq, secondDistanceSq);
+
+        labels[i] = (nearest >= 0 && distanceSq <= thresholdSq) ? nearest : -1;
+        addToCluster(labels[i], m_points.position(i));
+    }
+
+    for (size_t k = 0; k < m_clusterCounts.size(); ++k) {
+        if (m_clusterCounts[k] > 0) {
+            centroids[k] = calculateCentroid(k);
+        }
+    }
+
+    // Drop emptied clusters, then group the unassigned objects by the same rule as a full run
+    m_unassigned.clear();
+    maxClusters = determineMaxClusters(numObjects);
+    adjustClusterCount();
+
+    for (AkUInt32 i = 0; i < numObjects; ++i) {
+        if (labels[i] < 0) {
+            m_unassigned.push_back(i);
+        }
+    }
+    const size_t firstNewCluster = m_clusterCounts.size();
+    formLeaderClusters();
+    for (size_t k = firstNewCluster; k < m_clusterCounts.size(); ++k) {
+        centroids.push_back(calculateCentroid(k));
+    }
+
+    applyHysteresis(&m_dirtyObjects);
+    buildClusterMembership();
+    m_boundsValid = false;
+
+    m_previousCentroids = centroids;
+    m_previousClusterIds = m_clusterIds;
+    m_previousObjectCount = numObjects;
+
+    fillResult();
+    return true;
+}
+
+void KMeans::applyHysteresis(const std::vector<AkUInt32>* candidates) {
+    // m_result still holds the last run's clusters at this point
+    if (m_hysteresisMargin <= 0.0f || m_result.empty() || centroids.empty()) return;
+
+    // Match by position, since a cold start gives the same clusters new IDs
+    m_continuationTree.build(centroids.data(), static_cast<AkUInt32>(centroids.size()));
+    m_previousContinuation.resize(m_result.size());
+    for (size_t p = 0; p < m_result.size(); ++p) {
+        float distanceSq;
+        m_previousContinuation[p] = m_continuationTree.findNearest(m_result[p].centroid, m_distanceThreshold, distanceSq);
+    }
+
+    const float stayDistance = m_distanceThreshold + m_hysteresisMargin;
+    bool moved = false;
+
+    auto keepPrevious = [&](AkUInt32 i) {
+        const int previousIndex = m_result.findCluster(m_points.key(i));
+        if (previousIndex < 0) return;
+
+        const int previous = m_previousContinuation[previousIndex];
+        const int current = labels[i];
+        if (previous < 0 || previous == current) return;
+
+        // Leave only when clearly out of reach, or clearly closer to the new cluster
+        const AkVector position = m_points.position(i);
+        const float previousDistance = std::sqrt(m_utilities.GetDistanceSquared(position, centroids[previous]));
+        if (previousDistance > stayDistance) return;
+        if (current >= 0 && std::sqrt(m_utilities.GetDistanceSquared(position, centroids[current])) + m_hysteresisMargin < previousDistance) return;
+
+        removeFromCluster(current, position);
+        addToCluster(previous, position);
+        labels[i] = previous;
+        moved = true;
+    };
+
+    if (candidates) {
+        for (AkUInt32 i : *candidates) {
+            keepPrevious(i);
+        }
+    }
+    else {
+        for (AkUInt32 i = 0; i < m_points.size(); ++i) {
+            keepPrevious(i);
+        }
+    }
+    if (!moved) return;
+
+    for (size_t k = 0; k < m_clusterCounts.size(); ++k) {
+        if (m_clusterCounts[k] > 0) {
+            centroids[k] = calculateCentroid(k);
         }
     }
 
-    return clusterMap;
-}
\ No newline at end of file
+    // Objects taken back are no longer unassigned; the clusters they left may now be empty
+    m_unassigned.erase(std::remove_if(m_unassigned.begin(), m_unassigned.end(),
+        [this](AkUInt32 i) { return labels[i] >= 0; }), m_unassigned.end());
+    adjustClusterCount();
+    m_boundsValid = false;
+}
+
+void KMeans::removeFromCluster(int cluster, const AkVector& position) {
+    if (cluster < 0) return;
+
+    m_clusterCounts[cluster]--;
+    m_clusterSums[cluster].X -= position.X;
+    m_clusterSums[cluster].Y -= position.Y;
+    m_clusterSums[cluster].Z -= position.Z;
+    m_clusterSumSq[cluster] -= static_cast<double>(position.X) * position.X
+        + static_cast<double>(position.Y) * position.Y
+        + static_cast<double>(position.Z) * position.Z;
+}
+
+void KMeans::addToCluster(int cluster, const AkVector& position) {
+    if (cluster < 0) return;
+
+    m_clusterCounts[cluster]++;
+    m_clusterSums[cluster].X += position.X;
+    m_clusterSums[cluster].Y += position.Y;
+    m_clusterSums[cluster].Z += position.Z;
+    m_clusterSumSq[cluster] += static_cast<double>(position.X) * position.X
+        + static_cast<double>(position.Y) * position.Y
+        + static_cast<double>(position.Z) * position.Z;
+}
+
+const std::vector<int>& KMeans::getLabels() const {
+    return labels;
+}
+
+const std::vector<AkVector>& KMeans::getCentroids() const {
+    return centroids;
+}
+
+const ClusterResult& KMeans::getResult() const {
+    return m_result;
+}
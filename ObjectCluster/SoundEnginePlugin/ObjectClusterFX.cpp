@@ -33,6 +33,8 @@ trademarks of CCP ehf.
 #include "ObjectClusterFX.h"
 #include "../ObjectClusterConfig.h"
 #include <AK/AkWwiseSDKVersion.h>
+#include <algorithm>
+#include <cstdio>
 
 AK::IAkPlugin* CreateObjectClusterFX(AK::IAkPluginMemAlloc* in_pAllocator)
 {
@@ -51,7 +53,6 @@ ObjectClusterFX::ObjectClusterFX()
     : m_pParams(nullptr)
     , m_pAllocator(nullptr)
     , m_pContext(nullptr)
-    , m_kmeans(std::make_unique<KMeans>())
     , m_utilities(std::make_unique<Utilities>())
 {
 }
@@ -68,19 +69,38 @@ AKRESULT ObjectClusterFX::Init(AK::IAkPluginMemAlloc* in_pAllocator, AK::IAkEffe
     m_pContext = in_pContext;
     m_pAllocator = in_pAllocator;
 
-    in_rFormat.channelConfig.SetObject();
+    AKRESULT eResult = m_frameArena.Init(in_pAllocator, kFrameArenaSize);
+    if (eResult != AK_Success) {
+        return eResult;
+    }
 
-    // Set min-max values for the distance threshold
-    // These are specific to eve & frontier ships, adjust accordingly
-    m_kmeans->setMinDistanceThreshold(1.f);
-    m_kmeans->setMaxDistanceThreshold(1000.f);
+    in_rFormat.channelConfig.SetObject();
+    m_sampleRate = in_rFormat.uSampleRate;
+
+    UpdateClusteringEngine();
+    m_clusteredKeys.reserve(kReservedObjects);
+
+    // Pool threads are created here, not on the audio thread, and only when something will
+    // run on them: a worker for the background jobs, and as many as the thread count asks
+    // for. Later increases are left to the workers.
+    m_asyncClusterer = std::make_unique<AsyncClusterer>(&ObjectClusterFX::CreateClusteringEngine);
+    const AkInt32 threadCount = std::max<AkInt32>(m_pParams->NonRTPC.threadCount, 1);
+    if (m_pParams->NonRTPC.asyncClustering || threadCount > 1) {
+        m_asyncUnavailable = !m_asyncClusterer->joinPool(static_cast<unsigned int>(threadCount));
+    }
+    if (m_pParams->NonRTPC.asyncClustering) {
+        m_asyncClusterer->reserveJobs(kReservedObjects);
+    }
 
     return AK_Success;
 }
 
 AKRESULT ObjectClusterFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 {
+    // Waits for a background job in progress before the plugin memory goes away
+    m_asyncClusterer.reset();
     FreeAllVolumes();
+    m_frameArena.Term();
 
     AK_PLUGIN_DELETE(in_pAllocator, this);
     return AK_Success;
@@ -89,7 +109,6 @@ AKRESULT ObjectClusterFX::Term(AK::IAkPluginMemAlloc* in_pAllocator)
 AKRESULT ObjectClusterFX::Reset()
 {
     FreeAllVolumes();
-    m_clusters.clear();
     m_tempBuffers.clear();
     m_tempObjects.clear();
 
@@ -112,47 +131,162 @@ void ObjectClusterFX::Execute(
 ) {
     AKASSERT(inObjects.uNumObjects > 0);
 
+    // Everything allocated from the arena during the previous frame is gone from here on
+    m_frameArena.Reset();
+
     PrepareAudioObjects(inObjects);
     ProcessAudioObjects(inObjects);
-    UpdateClusterPositions(inObjects);
+    UpdateClusterPositions();
 }
 
 void ObjectClusterFX::PrepareAudioObjects(const AkAudioObjects& inObjects)
 {
-    FeedPositionsToKMeans(inObjects);
-    std::unordered_map<const std::pair<AkVector, std::vector<AkAudioObjectID>>*, AkAudioObjectID> clusterOutputObjects;
+    const bool clustersChanged = FeedPositionsToEngine(inObjects);
+    const ClusterResult& clusters = CurrentClusters();
+    if (clustersChanged) {
+        m_clusterTracker.update(clusters, m_pParams->RTPC.distanceThreshold);
+    }
+
+    // Built on the first FindBestCluster call of this frame, and again after cluster outputs were added
+    m_outputIndexValid = false;
+    bool clusterOutputsAdded = false;
+
+    // Output object of each cluster, indexed like the clustering result
+    ArenaVector<AkAudioObjectID> clusterOutputObjects(
+        clusters.size(), AK_INVALID_AUDIO_OBJECT_ID, ArenaAllocator<AkAudioObjectID>(&m_frameArena));
 
     // Get current outputs at start
     AkAudioObjects existingOutputs = GetCurrentOutputObjects();
 
-    // Update existing objects and map clusters to existing outputs
+    // Lets FindBestCluster pick the cluster outputs created earlier in the frame
+    const auto refreshOutputIndex = [&] {
+        if (clusterOutputsAdded) {
+            existingOutputs = GetCurrentOutputObjects();
+            m_outputIndexValid = false;
+            clusterOutputsAdded = false;
+        }
+    };
+
+    ArenaVector<AkAudioObjectID> liveOutputs{ ArenaAllocator<AkAudioObjectID>(&m_frameArena) };
+    liveOutputs.reserve(existingOutputs.uNumObjects);
+    for (AkUInt32 i = 0; i < existingOutputs.uNumObjects; ++i) {
+        if (existingOutputs.ppObjects[i]) {
+            liveOutputs.push_back(existingOutputs.ppObjects[i]->key);
+        }
+    }
+    std::sort(liveOutputs.begin(), liveOutputs.end());
+
+    // Each tracked cluster keeps the output tied to it, as long as that output is still there
+    ArenaVector<AkAudioObjectID> claimedOutputs{ ArenaAllocator<AkAudioObjectID>(&m_frameArena) };
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const AkAudioObjectID output = m_clusterTracker.output(c);
+        if (output == AK_INVALID_AUDIO_OBJECT_ID) continue;
+
+        if (std::binary_search(liveOutputs.begin(), liveOutputs.end(), output)) {
+            clusterOutputObjects[c] = output;
+            claimedOutputs.push_back(output);
+        }
+        else {
+            m_clusterTracker.setOutput(c, AK_INVALID_AUDIO_OBJECT_ID);
+        }
+    }
+    std::sort(claimedOutputs.begin(), claimedOutputs.end());
+
+    // Cluster of each input, -1 if new or not in any cluster
+    ArenaVector<int> inputClusters(inObjects.uNumObjects, -1, ArenaAllocator<int>(&m_frameArena));
+
+    // Update existing objects. A cluster without an output takes over the one its first
+    // member is mixed into, unless another cluster already has it.
     for (AkUInt32 i = 0; i < inObjects.uNumObjects; ++i) {
         AkAudioObject* inobj = inObjects.ppObjects[i];
         AkAudioObjectID key = inobj->key;
         GeneratedObject* pEntry = m_mapInObjsToOutObjs.Exists(key);
-        if (pEntry) {
-            pEntry->index = i;
+        if (!pEntry) continue;
+
+        pEntry->index = i;
+        const int cluster = clusters.findCluster(key);
+        inputClusters[i] = cluster;
+        TrackMembership(*pEntry, cluster);
+
+        if (cluster < 0 || !pEntry->isClustered || clusterOutputObjects[cluster] != AK_INVALID_AUDIO_OBJECT_ID) continue;
+
+        const AkAudioObjectID output = pEntry->outputObjKey;
+        auto claimed = std::lower_bound(claimedOutputs.begin(), claimedOutputs.end(), output);
+        if ((claimed == claimedOutputs.end() || *claimed != output)
+            && std::binary_search(liveOutputs.begin(), liveOutputs.end(), output)) {
+            clusterOutputObjects[cluster] = output;
+            m_clusterTracker.setOutput(cluster, output);
+            claimedOutputs.insert(claimed, output);
         }
     }
 
-    // For each cluster, try to find if any of its objects are using an existing output
-    if (existingOutputs.uNumObjects > 0) {
-        for (const auto& cluster : m_clusters) {
-            for (const auto& objId : cluster.second) {
-                GeneratedObject* pEntry = m_mapInObjsToOutObjs.Exists(objId);
-                if (pEntry && pEntry->isClustered) {
-                    // Verify this output still exists
-                    for (AkUInt32 i = 0; i < existingOutputs.uNumObjects; i++) {
-                        if (existingOutputs.ppObjects[i] &&
-                            existingOutputs.ppObjects[i]->key == pEntry->outputObjKey) {
-                            clusterOutputObjects[&cluster] = pEntry->outputObjKey;
-                            break;
-                        }
-                    }
-                    if (clusterOutputObjects.find(&cluster) != clusterOutputObjects.end()) {
-                        break;  // Found valid output for this cluster
-                    }
-                }
+    // Turn the changes into a rate once a second of audio has gone by
+    m_churnFrames += inObjects.ppObjectBuffers[0]->MaxFrames();
+    if (m_sampleRate > 0 && m_churnFrames >= m_sampleRate) {
+        m_membershipChurn = static_cast<AkReal32>(m_membershipChanges) * m_sampleRate / m_churnFrames;
+        m_membershipChanges = 0;
+        m_churnFrames = 0;
+
+        // Sent as plugin monitor data, not to the capture log, and only while monitored
+        if (m_pContext->CanPostMonitorData()) {
+            ObjectClusterMonitorData monitorData;
+            monitorData.membershipChurn = GetMembershipChurn();
+            m_pContext->PostMonitorData(&monitorData, sizeof(monitorData));
+        }
+    }
+
+    // Move inputs to the output of the cluster they are in now. A cluster that split off from
+    // the one owning their output gets an output of its own. Inputs that were in no cluster
+    // when they appeared, as when the result in use predates them, join theirs here once a
+    // newer result has them in one.
+    for (AkUInt32 i = 0; i < inObjects.uNumObjects; ++i) {
+        const int cluster = inputClusters[i];
+        if (cluster < 0) continue;
+
+        AkAudioObject* inobj = inObjects.ppObjects[i];
+        GeneratedObject* pEntry = m_mapInObjsToOutObjs.Exists(inobj->key);
+
+        if (clusterOutputObjects[cluster] == AK_INVALID_AUDIO_OBJECT_ID) {
+            const AkAudioObjectID output = m_utilities->CreateOutputObject(inobj, inObjects, i, m_pContext, &m_clusterCentroids[cluster]);
+            if (output == AK_INVALID_AUDIO_OBJECT_ID) continue;
+
+            clusterOutputObjects[cluster] = output;
+            m_clusterTracker.setOutput(cluster, output);
+            clusterOutputsAdded = true;
+        }
+        if (pEntry->outputObjKey != clusterOutputObjects[cluster]) {
+            MigrateInput(*pEntry, clusterOutputObjects[cluster], true);
+        }
+    }
+
+    // Inputs a newer result has in no cluster leave their cluster's output, for the nearest other
+    // clustered output within the threshold or else an output of their own
+    if (clustersChanged) {
+        ArenaVector<AkAudioObjectID> clusterOutputs(clusterOutputObjects.begin(), clusterOutputObjects.end(),
+            ArenaAllocator<AkAudioObjectID>(&m_frameArena));
+        std::sort(clusterOutputs.begin(), clusterOutputs.end());
+
+        for (AkUInt32 i = 0; i < inObjects.uNumObjects; ++i) {
+            if (inputClusters[i] >= 0) continue;
+
+            AkAudioObject* inobj = inObjects.ppObjects[i];
+            GeneratedObject* pEntry = m_mapInObjsToOutObjs.Exists(inobj->key);
+            if (!pEntry || !pEntry->isClustered) continue;
+
+            AkAudioObjectID bestClusterKey;
+            refreshOutputIndex();
+            const bool found = FindBestCluster(inobj->positioning.threeD.xform.Position(), existingOutputs, bestClusterKey) == AK_Success;
+            if (found && bestClusterKey != pEntry->outputObjKey) {
+                MigrateInput(*pEntry, bestClusterKey, true);
+                continue;
+            }
+
+            // Staying is fine while the output still belongs to a cluster, not once the input is all that is left of it
+            if (found && std::binary_search(clusterOutputs.begin(), clusterOutputs.end(), bestClusterKey)) continue;
+
+            const AkAudioObjectID output = m_utilities->CreateOutputObject(inobj, inObjects, i, m_pContext, nullptr);
+            if (output != AK_INVALID_AUDIO_OBJECT_ID) {
+                MigrateInput(*pEntry, output, false);
             }
         }
     }
@@ -171,34 +305,34 @@ void ObjectClusterFX::PrepareAudioObjects(const AkAudioObjects& inObjects)
                 inobj->positioning.behavioral.spatMode == AK_SpatializationMode_PositionAndOrientation);
 
             if (isPositionedObject) {
-                // Find which cluster this object belongs to from KMeans results
-                const std::pair<AkVector, std::vector<AkAudioObjectID>>* assignedCluster = nullptr;
-                for (const auto& cluster : m_clusters) {
-                    auto it = std::find(cluster.second.begin(), cluster.second.end(), key);
-                    if (it != cluster.second.end()) {
-                        assignedCluster = &cluster;
-                        break;
-                    }
-                }
+                // Find which cluster this object belongs to from the clustering result
+                const int assignedCluster = clusters.findCluster(key);
+
+                if (assignedCluster >= 0) {
+                    pEntry->clusterId = m_clusterTracker.id(assignedCluster);
+                    pEntry->hasCluster = true;
 
-                if (assignedCluster) {
                     // Check if we have an existing output for this cluster
-                    auto outputObjIt = clusterOutputObjects.find(assignedCluster);
-                    if (outputObjIt != clusterOutputObjects.end()) {
+                    if (clusterOutputObjects[assignedCluster] != AK_INVALID_AUDIO_OBJECT_ID) {
                         // Use existing cluster output
-                        pEntry->outputObjKey = outputObjIt->second;
+                        pEntry->outputObjKey = clusterOutputObjects[assignedCluster];
                         pEntry->isClustered = true;
                     }
                     else {
                         // Create new output for this cluster
-                        pEntry->outputObjKey = m_utilities->CreateOutputObject(inobj, inObjects, i, m_pContext, &assignedCluster->first);
+                        pEntry->outputObjKey = m_utilities->CreateOutputObject(inobj, inObjects, i, m_pContext, &m_clusterCentroids[assignedCluster]);
                         clusterOutputObjects[assignedCluster] = pEntry->outputObjKey;
+                        m_clusterTracker.setOutput(assignedCluster, pEntry->outputObjKey);
                         pEntry->isClustered = true;
+                        if (pEntry->outputObjKey != AK_INVALID_AUDIO_OBJECT_ID) {
+                            clusterOutputsAdded = true;
+                        }
                     }
                 }
                 else {
                     // Try to find nearest existing cluster
                     AkAudioObjectID bestClusterKey;
+                    refreshOutputIndex();
                     if (FindBestCluster(inobj->positioning.threeD.xform.Position(), existingOutputs, bestClusterKey) == AK_Success) {
                         pEntry->outputObjKey = bestClusterKey;
                         pEntry->isClustered = true;
@@ -223,6 +357,18 @@ void ObjectClusterFX::PrepareAudioObjects(const AkAudioObjects& inObjects)
     m_tempObjects.clear();
 }
 
+void ObjectClusterFX::TrackMembership(GeneratedObject& entry, int cluster)
+{
+    const bool hasCluster = cluster >= 0;
+    const AkUInt32 clusterId = hasCluster ? m_clusterTracker.id(cluster) : 0;
+
+    if (hasCluster != entry.hasCluster || clusterId != entry.clusterId) {
+        ++m_membershipChanges;
+    }
+    entry.clusterId = clusterId;
+    entry.hasCluster = hasCluster;
+}
+
 void ObjectClusterFX::ProcessAudioObjects(const AkAudioObjects& inObjects)
 {
     if (inObjects.uNumObjects == 0) {
@@ -235,6 +381,9 @@ void ObjectClusterFX::ProcessAudioObjects(const AkAudioObjects& inObjects)
         auto clusterStates = ReadClusterStates(inObjects);
         m_utilities->ClearBuffers(outputObjects);
 
+        // Outputs nothing is mixed into any more are retired after the loop
+        ArenaVector<AkUInt8> outputUsed(outputObjects.uNumObjects, 0, ArenaAllocator<AkUInt8>(&m_frameArena));
+
         auto it = m_mapInObjsToOutObjs.Begin();
         while (it != m_mapInObjsToOutObjs.End()) {
             if ((*it).pUserData && (*it).pUserData->index >= 0) {
@@ -251,6 +400,7 @@ void ObjectClusterFX::ProcessAudioObjects(const AkAudioObjects& inObjects)
                         outputObjects.ppObjects[i]->key == (*it).pUserData->outputObjKey) {
                         outObj = outputObjects.ppObjects[i];
                         outBuf = outputObjects.ppObjectBuffers[i];
+                        outputUsed[i] = 1;
                         break;
                     }
                 }
@@ -271,8 +421,28 @@ void ObjectClusterFX::ProcessAudioObjects(const AkAudioObjects& inObjects)
                             inObj,
                             inBuf,
                             outObj,
-                            outBuf);
+                            outBuf,
+                            (*it).pUserData);
+                    }
+                }
+
+                // Fade out of the output the input migrated away from
+                const AkAudioObjectID fadeKey = (*it).pUserData->fadeOutputObjKey;
+                if (fadeKey != AK_INVALID_AUDIO_OBJECT_ID) {
+                    for (AkUInt32 i = 0; i < outputObjects.uNumObjects; i++) {
+                        if (outputObjects.ppObjects[i] && outputObjects.ppObjects[i]->key == fadeKey) {
+                            if ((*it).pUserData->fadeIsClustered) {
+                                FadeOutOfCluster(inObj, inBuf, outputObjects.ppObjectBuffers[i], (*it).pUserData, clusterStates[fadeKey]);
+                            }
+                            else {
+                                FadeOutOfUnclustered(inBuf, outputObjects.ppObjectBuffers[i]);
+                            }
+                            outputUsed[i] = 1;
+                            break;
+                        }
                     }
+                    FreeVolume((*it).pUserData->fadeVolumeMatrix);
+                    (*it).pUserData->fadeOutputObjKey = AK_INVALID_AUDIO_OBJECT_ID;
                 }
 
                 (*it).pUserData->index = -1;
@@ -280,12 +450,21 @@ void ObjectClusterFX::ProcessAudioObjects(const AkAudioObjects& inObjects)
             }
             else {
 
-                if ((*it).pUserData && (*it).pUserData->volumeMatrix) {
+                if ((*it).pUserData) {
                     FreeVolume((*it).pUserData->volumeMatrix);
+                    FreeVolume((*it).pUserData->fadeVolumeMatrix);
                 }
                 it = m_mapInObjsToOutObjs.EraseSwap(it);
             }
         }
+
+        // Left behind by migrations or by inputs that ended; an output ends once it reports no more data
+        for (AkUInt32 i = 0; i < outputObjects.uNumObjects; i++) {
+            if (!outputUsed[i] && outputObjects.ppObjectBuffers[i]) {
+                outputObjects.ppObjectBuffers[i]->eState = AK_NoMoreData;
+                outputObjects.ppObjectBuffers[i]->uValidFrames = 0;
+            }
+        }
     }
 
     m_tempBuffers.clear();
@@ -302,12 +481,18 @@ void ObjectClusterFX::ProcessClusteredObject(
 {
 
     if (inBuf->uValidFrames > 0) {
-        MixToCluster(inObj, inBuf, outBuf, inObj->cumulativeGain, userData);
+        // An input that just migrated here fades in while it fades out of its old output
+        AkRamp gain = inObj->cumulativeGain;
+        if (userData->fadeOutputObjKey != AK_INVALID_AUDIO_OBJECT_ID) {
+            gain.fPrev = 0.f;
+        }
+        MixToCluster(inObj, inBuf, outBuf, gain, userData->volumeMatrix);
     }
 
     // Set clustered object's name
-    std::string objName = "Cluster" + std::to_string(userData->outputObjKey);
-    outObj->SetName(m_pAllocator, objName.c_str());
+    char objName[32];
+    snprintf(objName, sizeof(objName), "Cluster%llu", static_cast<unsigned long long>(userData->outputObjKey));
+    outObj->SetName(m_pAllocator, objName);
 
     // Update buffer state
     bool allInputsDone = (clusterState.activeInputCount == 0);
@@ -317,13 +502,67 @@ void ObjectClusterFX::ProcessClusteredObject(
     outBuf->uValidFrames = hasValidFrames ? clusterState.maxFrames : 0;
 }
 
+void ObjectClusterFX::FadeOutOfCluster(
+    const AkAudioObject* inObj,
+    AkAudioBuffer* inBuf,
+    AkAudioBuffer* outBuf,
+    GeneratedObject* userData,
+    const ClusterState& clusterState)
+{
+    if (inBuf->uValidFrames > 0) {
+        AkRamp gain = inObj->cumulativeGain;
+        gain.fNext = 0.f;
+        MixToCluster(inObj, inBuf, outBuf, gain, userData->fadeVolumeMatrix);
+    }
+
+    // The output may have no input left, it still plays out the fade
+    bool allInputsDone = (clusterState.activeInputCount == 0);
+    bool hasValidFrames = (clusterState.maxFrames > 0);
+
+    outBuf->eState = (allInputsDone && !hasValidFrames) ? AK_NoMoreData : AK_DataReady;
+    outBuf->uValidFrames = hasValidFrames ? clusterState.maxFrames : 0;
+
+    // Even when the last member just left, the fade it mixed above has to be played
+    AKASSERT(inBuf->uValidFrames == 0 || (outBuf->eState == AK_DataReady && outBuf->uValidFrames >= inBuf->uValidFrames));
+}
+
+void ObjectClusterFX::FadeOutOfUnclustered(
+    AkAudioBuffer* inBuf,
+    AkAudioBuffer* outBuf)
+{
+    m_utilities->MixBufferRamped(inBuf, outBuf, 1.f, 0.f);
+    outBuf->eState = inBuf->uValidFrames > 0 ? AK_DataReady : AK_NoMoreData;
+    outBuf->uValidFrames = inBuf->uValidFrames;
+}
+
+void ObjectClusterFX::MigrateInput(GeneratedObject& entry, AkAudioObjectID outputObjKey, bool isClustered)
+{
+    // Only one fade at a time: a fade that did not get to play is dropped
+    FreeVolume(entry.fadeVolumeMatrix);
+
+    // The new output may have another channel configuration, so its volumes start over
+    entry.fadeOutputObjKey = entry.outputObjKey;
+    entry.fadeVolumeMatrix = entry.volumeMatrix;
+    entry.fadeIsClustered = entry.isClustered;
+    entry.volumeMatrix = nullptr;
+    entry.outputObjKey = outputObjKey;
+    entry.isClustered = isClustered;
+}
+
 void ObjectClusterFX::ProcessUnclustered(
     const AkAudioObject* inObj,
     AkAudioBuffer* inBuf,
     AkAudioObject* outObj,
-    AkAudioBuffer* outBuf) {
+    AkAudioBuffer* outBuf,
+    const GeneratedObject* userData) {
 
-    m_utilities->CopyBuffer(inBuf, outBuf);
+    // An input that just left a cluster fades in while it fades out of the cluster's output
+    if (userData->fadeOutputObjKey != AK_INVALID_AUDIO_OBJECT_ID) {
+        m_utilities->MixBufferRamped(inBuf, outBuf, 0.f, 1.f);
+    }
+    else {
+        m_utilities->CopyBuffer(inBuf, outBuf);
+    }
     outObj->positioning.threeD.xform.SetPosition(inObj->positioning.threeD.xform.Position());
     outObj->arCustomMetadata.Copy(inObj->arCustomMetadata);
     outBuf->eState = inBuf->eState;
@@ -331,7 +570,7 @@ void ObjectClusterFX::ProcessUnclustered(
     outObj->SetName(m_pAllocator, "Not clustered");
 }
 
-void ObjectClusterFX::MixToCluster(const AkAudioObject* inObject, AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer, const AkRamp& cumulativeGain, GeneratedObject* pGeneratedObject)
+void ObjectClusterFX::MixToCluster(const AkAudioObject* inObject, AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer, const AkRamp& cumulativeGain, AK::SpeakerVolumes::MatrixPtr& volumeMatrix)
 {
     if (inBuffer->uValidFrames == 0 || inBuffer->NumChannels() == 0 || outBuffer->NumChannels() == 0) {
         return;
@@ -350,10 +589,10 @@ void ObjectClusterFX::MixToCluster(const AkAudioObject* inObject, AkAudioBuffer*
     );
 
     // If mixVolumes doesn't exist, allocate and set it to the current volumes
-    if (pGeneratedObject->volumeMatrix == nullptr) {
-        AKRESULT eResult = AllocateVolumes(pGeneratedObject->volumeMatrix, inBuffer->NumChannels(), outBuffer->NumChannels());
+    if (volumeMatrix == nullptr) {
+        AKRESULT eResult = AllocateVolumes(volumeMatrix, inBuffer->NumChannels(), outBuffer->NumChannels());
         if (eResult == AK_Success) {
-            AKPLATFORM::AkMemCpy(pGeneratedObject->volumeMatrix, currentVolumes, uTransmixSize);
+            AKPLATFORM::AkMemCpy(volumeMatrix, currentVolumes, uTransmixSize);
         }
     }
 
@@ -362,24 +601,95 @@ void ObjectClusterFX::MixToCluster(const AkAudioObject* inObject, AkAudioBuffer*
         outBuffer,
         cumulativeGain.fPrev,
         cumulativeGain.fNext,
-        pGeneratedObject->volumeMatrix,
+        volumeMatrix,
         currentVolumes
     );
 
-    AKPLATFORM::AkMemCpy(pGeneratedObject->volumeMatrix, currentVolumes, uTransmixSize);
+    AKPLATFORM::AkMemCpy(volumeMatrix, currentVolumes, uTransmixSize);
+}
+
+std::unique_ptr<IClusteringEngine> ObjectClusterFX::CreateClusteringEngine(AkInt32 engineType)
+{
+    if (engineType == ClusteringEngine_Agglomerative) {
+        auto agglomerative = std::make_unique<AgglomerativeClustering>();
+        agglomerative->setMinDistanceThreshold(1.f);
+        agglomerative->setMaxDistanceThreshold(1000.f);
+        return agglomerative;
+    }
+    if (engineType == ClusteringEngine_GridDensity) {
+        return std::make_unique<GridDensityClustering>();
+    }
+
+    auto kmeans = std::make_unique<KMeans>();
+
+    // Set min-max values for the distance threshold
+    // These are specific to eve & frontier ships, adjust accordingly
+    kmeans->setMinDistanceThreshold(1.f);
+    kmeans->setMaxDistanceThreshold(1000.f);
+
+    return kmeans;
+}
+
+ClusteringSettings ObjectClusterFX::GetClusteringSettings() const
+{
+    ClusteringSettings settings;
+    settings.distanceThreshold = m_pParams->RTPC.distanceThreshold;
+    settings.warmStart = m_pParams->NonRTPC.warmStart;
+    settings.coresetSize = static_cast<unsigned int>(m_pParams->NonRTPC.coresetSize);
+    settings.miniBatchSize = static_cast<unsigned int>(m_pParams->NonRTPC.miniBatchSize);
+    settings.timeBudgetUs = static_cast<AkUInt32>(m_pParams->NonRTPC.timeBudget);
+    settings.threadCount = static_cast<unsigned int>(std::max<AkInt32>(m_pParams->NonRTPC.threadCount, 1));
+    settings.movementEpsilon = m_pParams->NonRTPC.movementEpsilon;
+    settings.maxChangedFraction = static_cast<float>(m_pParams->NonRTPC.maxChangedPercent) / 100.0f;
+    settings.hysteresisMargin = m_pParams->NonRTPC.hysteresisMargin;
+    return settings;
 }
 
-void ObjectClusterFX::FeedPositionsToKMeans(const AkAudioObjects& inObjects)
+void ObjectClusterFX::UpdateClusteringEngine()
 {
+    if (m_engine && m_engineType == m_pParams->NonRTPC.clusteringEngine) {
+        return;
+    }
 
-    if (m_lastDistanceThreshold != m_pParams->RTPC.distanceThreshold) {
-        m_kmeans->setDistanceThreshold(m_pParams->RTPC.distanceThreshold);
-        m_lastDistanceThreshold = m_pParams->RTPC.distanceThreshold;
+    m_engineType = m_pParams->NonRTPC.clusteringEngine;
+    m_engine = CreateClusteringEngine(m_engineType);
+}
+
+bool ObjectClusterFX::UpdateAsyncClustering()
+{
+    if (!m_pParams->NonRTPC.asyncClustering || m_asyncUnavailable) {
+        // A job in progress finishes in the background, the clusterer is kept for when the parameter comes back
+        m_asyncClusterer->stop();
+        return false;
     }
 
-    std::vector<ObjectPosition> objectPositions;
+    // Joined the pool in Init if the parameter was set then; otherwise this is where the
+    // worker gets created, and a failure is not retried every frame
+    if (!m_asyncClusterer->start()) {
+        m_asyncUnavailable = true;
+        return false;
+    }
+    return true;
+}
+
+bool ObjectClusterFX::FeedPositionsToEngine(const AkAudioObjects& inObjects)
+{
+    const bool async = UpdateAsyncClustering();
+
+    const AkUInt32 frames = inObjects.ppObjectBuffers[0]->MaxFrames();
+    const float frameSeconds = m_sampleRate > 0 ? static_cast<float>(frames) / m_sampleRate : 0.0f;
+    const float horizonSeconds = static_cast<float>(m_pParams->NonRTPC.predictionHorizon) / 1000.0f;
+    const bool predict = horizonSeconds > 0.0f;
+
+    ArenaVector<ObjectPosition> objectPositions{ ArenaAllocator<ObjectPosition>(&m_frameArena) };
     objectPositions.reserve(inObjects.uNumObjects);
 
+    // Positions the engine clusters, ahead of the real ones when predicting
+    ArenaVector<ObjectPosition> predictedPositions{ ArenaAllocator<ObjectPosition>(&m_frameArena) };
+    if (predict) {
+        predictedPositions.reserve(inObjects.uNumObjects);
+    }
+
     for (AkUInt32 i = 0; i < inObjects.uNumObjects; ++i) {
         AkAudioObject* inobj = inObjects.ppObjects[i];
 
@@ -388,21 +698,143 @@ void ObjectClusterFX::FeedPositionsToKMeans(const AkAudioObjects& inObjects)
             inobj->positioning.behavioral.spatMode == AK_SpatializationMode_PositionAndOrientation);
 
         if (shouldCluster) {
-            objectPositions.push_back({ inobj->positioning.threeD.xform.Position(), inobj->key });
+            const AkVector position = inobj->positioning.threeD.xform.Position();
+            objectPositions.push_back({ position, inobj->key });
+
+            if (predict) {
+                // Inputs seen for the first time have no state yet and are clustered where they are
+                GeneratedObject* pEntry = m_mapInObjsToOutObjs.Exists(inobj->key);
+                predictedPositions.push_back({ pEntry ? PredictPosition(*pEntry, position, frameSeconds, horizonSeconds) : position, inobj->key });
+            }
         }
     }
-    // Perform clustering only if there are objects
-    m_clusters.clear();
-    if (!objectPositions.empty()) {
-        m_kmeans->performClustering(objectPositions);
+    const ArenaVector<ObjectPosition>& enginePositions = predict ? predictedPositions : objectPositions;
+
+    // Positions by key, to spot added or removed objects and to move cached clusters along with their members.
+    // Only needed when the result in use may not come from this frame's real positions.
+    const AkInt32 interval = std::max<AkInt32>(m_pParams->NonRTPC.clusteringInterval, 1);
+    ArenaVector<ObjectPosition> positionsByKey{ ArenaAllocator<ObjectPosition>(&m_frameArena) };
+    if (interval > 1 || async || predict) {
+        positionsByKey.assign(objectPositions.begin(), objectPositions.end());
+        std::sort(positionsByKey.begin(), positionsByKey.end(),
+            [](const ObjectPosition& a, const ObjectPosition& b) { return a.key < b.key; });
+    }
 
-        auto tempClusters = m_kmeans->getClusters();
-        m_clusters.reserve(tempClusters.size());
+    const ClusteringSettings settings = GetClusteringSettings();
+    const bool switchedMode = async != m_clusteredAsync;
+    const bool due = interval == 1
+        || ++m_framesSinceClustering >= interval
+        || async != m_clusteredAsync
+        || m_pParams->NonRTPC.clusteringEngine != m_clusteredEngineType
+        || settings != m_clusteredSettings
+        || !SameKeys(positionsByKey, m_clusteredKeys);
+
+    if (due) {
+        m_framesSinceClustering = 0;
+        m_clusteredAsync = async;
+        m_clusteredEngineType = m_pParams->NonRTPC.clusteringEngine;
+        m_clusteredSettings = settings;
+        m_clusteredKeys.clear();
+        for (const ObjectPosition& object : positionsByKey) {
+            m_clusteredKeys.push_back(object.key);
+        }
+    }
 
-        for (const auto& pair : tempClusters) {
-            m_clusters.emplace_back(pair.first, pair.second);
+    if (async) {
+        if (due) {
+            // The job storage is reserved in Init and reused, so this only allocates past kReservedObjects
+            AsyncClusterer::Job& job = m_asyncClusterer->jobBuffer();
+            job.objects.assign(enginePositions.begin(), enginePositions.end());
+            job.engineType = m_pParams->NonRTPC.clusteringEngine;
+            job.settings = settings;
+
+            // The result is wanted by the next frame
+            const auto frameDuration = std::chrono::microseconds(static_cast<AkInt64>(frameSeconds * 1000000.0f));
+            m_asyncClusterer->submitJob(WorkerPool::Clock::now() + frameDuration);
         }
+        // After a switch the current result is the pool's, even before it delivered one
+        const bool changed = m_asyncClusterer->acquireResult() || switchedMode;
+        UpdateClusterCentroids(&positionsByKey);
+        return changed;
     }
+
+    if (due) {
+        UpdateClusteringEngine();
+        m_engine->configure(settings);
+
+        // With no objects this only clears the previous result
+        m_engine->cluster(enginePositions.data(), static_cast<AkUInt32>(enginePositions.size()));
+    }
+    UpdateClusterCentroids(due && !predict ? nullptr : &positionsByKey);
+    return due;
+}
+
+AkVector ObjectClusterFX::PredictPosition(GeneratedObject& entry, const AkVector& position, float frameSeconds, float horizonSeconds)
+{
+    if (entry.hasLastPosition && frameSeconds > 0.0f) {
+        const AkVector frameVelocity{
+            (position.X - entry.lastPosition.X) / frameSeconds,
+            (position.Y - entry.lastPosition.Y) / frameSeconds,
+            (position.Z - entry.lastPosition.Z) / frameSeconds };
+
+        // Smoothing keeps frame jitter from throwing the prediction around
+        entry.velocity.X += kVelocitySmoothing * (frameVelocity.X - entry.velocity.X);
+        entry.velocity.Y += kVelocitySmoothing * (frameVelocity.Y - entry.velocity.Y);
+        entry.velocity.Z += kVelocitySmoothing * (frameVelocity.Z - entry.velocity.Z);
+    }
+    entry.lastPosition = position;
+    entry.hasLastPosition = true;
+
+    return AkVector{
+        position.X + entry.velocity.X * horizonSeconds,
+        position.Y + entry.velocity.Y * horizonSeconds,
+        position.Z + entry.velocity.Z * horizonSeconds };
+}
+
+bool ObjectClusterFX::SameKeys(const ArenaVector<ObjectPosition>& positionsByKey, const std::vector<AkAudioObjectID>& keys)
+{
+    if (positionsByKey.size() != keys.size()) return false;
+
+    for (size_t i = 0; i < keys.size(); ++i) {
+        if (positionsByKey[i].key != keys[i]) return false;
+    }
+    return true;
+}
+
+void ObjectClusterFX::UpdateClusterCentroids(const ArenaVector<ObjectPosition>* positionsByKey)
+{
+    const ClusterResult& clusters = CurrentClusters();
+    m_clusterCentroids.resize(clusters.size());
+
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        m_clusterCentroids[c] = clusters[c].centroid;
+        if (!positionsByKey) continue;
+
+        // Mean of the members' current positions; members that are gone no longer count
+        AkVector sum{ 0, 0, 0 };
+        AkUInt32 found = 0;
+        for (AkAudioObjectID key : clusters[c].members) {
+            auto it = std::lower_bound(positionsByKey->begin(), positionsByKey->end(), key,
+                [](const ObjectPosition& object, AkAudioObjectID value) { return object.key < value; });
+            if (it != positionsByKey->end() && it->key == key) {
+                sum.X += it->position.X;
+                sum.Y += it->position.Y;
+                sum.Z += it->position.Z;
+                ++found;
+            }
+        }
+        if (found > 0) {
+            m_clusterCentroids[c] = { sum.X / found, sum.Y / found, sum.Z / found };
+        }
+    }
+}
+
+const ClusterResult& ObjectClusterFX::CurrentClusters() const
+{
+    if (m_asyncClusterer && m_asyncClusterer->isRunning()) {
+        return m_asyncClusterer->result();
+    }
+    return m_engine->getResult();
 }
 
 AKRESULT ObjectClusterFX::AllocateVolumes(AK::SpeakerVolumes::MatrixPtr& volumeMatrix,
@@ -420,16 +852,9 @@ AKRESULT ObjectClusterFX::AllocateVolumes(AK::SpeakerVolumes::MatrixPtr& volumeM
     return AK_Success;
 }
 
-const std::pair<AkVector, std::vector<AkAudioObjectID>>* ObjectClusterFX::GetCluster(AkAudioObjectID objectId) const
+int ObjectClusterFX::GetClusterIndex(AkAudioObjectID objectId) const
 {
-    for (const auto& cluster : m_clusters) {
-        for (const auto& id : cluster.second) {
-            if (id == objectId) {
-                return &cluster;
-            }
-        }
-    }
-    return nullptr;
+    return CurrentClusters().findCluster(objectId);
 }
 
 void ObjectClusterFX::FreeVolume(AK::SpeakerVolumes::MatrixPtr& volumeMatrix)
@@ -444,20 +869,22 @@ void ObjectClusterFX::FreeAllVolumes()
 {
     auto it = m_mapInObjsToOutObjs.Begin();
     while (it != m_mapInObjsToOutObjs.End()) {
-        if ((*it).pUserData && (*it).pUserData->volumeMatrix) {
+        if ((*it).pUserData) {
             FreeVolume((*it).pUserData->volumeMatrix);
+            FreeVolume((*it).pUserData->fadeVolumeMatrix);
         }
         ++it;
     }
 }
 
-void ObjectClusterFX::UpdateClusterPositions(const AkAudioObjects& inObjects)
+void ObjectClusterFX::UpdateClusterPositions()
 {
     AkAudioObjects outputObjects = GetCurrentOutputObjects();
     if (outputObjects.uNumObjects == 0) return;
 
     // Track which clusters we've already processed to avoid duplicates
-    std::set<AkAudioObjectID> processedClusters;
+    std::set<AkAudioObjectID, std::less<AkAudioObjectID>, ArenaAllocator<AkAudioObjectID>> processedClusters{
+        ArenaAllocator<AkAudioObjectID>(&m_frameArena) };
 
     auto it = m_mapInObjsToOutObjs.Begin();
     while (it != m_mapInObjsToOutObjs.End()) {
@@ -466,9 +893,10 @@ void ObjectClusterFX::UpdateClusterPositions(const AkAudioObjects& inObjects)
 
             if (processedClusters.find(clusterKey) == processedClusters.end()) {
                 // Find the corresponding cluster
-                const std::pair<AkVector, std::vector<AkAudioObjectID>>* cluster = GetCluster((*it).key);
-                if (cluster) {
-                    AkVector meanPosition = m_utilities->CalculateMeanPosition(cluster->second, inObjects);
+                const int cluster = GetClusterIndex((*it).key);
+                if (cluster >= 0) {
+                    // The mean of the member positions, kept current between clustering runs
+                    const AkVector& meanPosition = m_clusterCentroids[cluster];
 
                     // Find and update the output object for this cluster
                     for (AkUInt32 i = 0; i < outputObjects.uNumObjects; i++) {
@@ -485,51 +913,62 @@ void ObjectClusterFX::UpdateClusterPositions(const AkAudioObjects& inObjects)
     }
 }
 
-AKRESULT ObjectClusterFX::FindBestCluster(const AkVector& position, const AkAudioObjects& existingOutputs, AkAudioObjectID& outClusterKey)
+void ObjectClusterFX::BuildOutputIndex(const AkAudioObjects& existingOutputs)
 {
-    const float thresholdSquared = m_pParams->RTPC.distanceThreshold * m_pParams->RTPC.distanceThreshold;
-    float closestDistanceSquared = thresholdSquared;
-    outClusterKey = AK_INVALID_AUDIO_OBJECT_ID;
+    // Keys of the outputs that at least one clustered input is mixed into
+    ArenaVector<AkAudioObjectID> clusteredOutputs{ ArenaAllocator<AkAudioObjectID>(&m_frameArena) };
+    for (auto it = m_mapInObjsToOutObjs.Begin(); it != m_mapInObjsToOutObjs.End(); ++it) {
+        const GeneratedObject* userData = (*it).pUserData;
+        if (userData && userData->isClustered) {
+            clusteredOutputs.push_back(userData->outputObjKey);
+        }
+    }
+    std::sort(clusteredOutputs.begin(), clusteredOutputs.end());
 
-    for (AkUInt32 i = 0; i < existingOutputs.uNumObjects; ++i)
-    {
+    m_outputIndexKeys.clear();
+    m_outputIndexPositions.clear();
+    for (AkUInt32 i = 0; i < existingOutputs.uNumObjects; ++i) {
         const AkAudioObject* outObj = existingOutputs.ppObjects[i];
-        if (!outObj) continue;
-
-        const AkVector outObjPos = outObj->positioning.threeD.xform.Position();
-
-        // Check all possible matches for this output object
-        auto existingEntry = m_mapInObjsToOutObjs.Begin();
-        while (existingEntry != m_mapInObjsToOutObjs.End())
-        {
-            const GeneratedObject* userData = (*existingEntry).pUserData;
-            if (userData &&
-                userData->isClustered &&
-                userData->outputObjKey == outObj->key)  // Found matching cluster
-            {
-                const float distanceSquared = m_utilities->GetDistanceSquared(outObjPos, position);
-                if (distanceSquared < closestDistanceSquared) {
-                    closestDistanceSquared = distanceSquared;
-                    outClusterKey = outObj->key;
-                }
-            }
-            ++existingEntry;
+        if (outObj && std::binary_search(clusteredOutputs.begin(), clusteredOutputs.end(), outObj->key)) {
+            m_outputIndexKeys.push_back(outObj->key);
+            m_outputIndexPositions.push_back(outObj->positioning.threeD.xform.Position());
         }
     }
 
+    m_outputIndex.build(m_outputIndexPositions.data(), static_cast<AkUInt32>(m_outputIndexPositions.size()));
+    m_outputIndexValid = true;
+}
+
+AKRESULT ObjectClusterFX::FindBestCluster(const AkVector& position, const AkAudioObjects& existingOutputs, AkAudioObjectID& outClusterKey)
+{
+    if (!m_outputIndexValid) {
+        BuildOutputIndex(existingOutputs);
+    }
+
+    const float threshold = m_pParams->RTPC.distanceThreshold;
+    float distanceSquared;
+    const int nearest = m_outputIndex.findNearest(position, threshold, distanceSquared);
+
+    // Only outputs strictly closer than the threshold qualify
+    outClusterKey = (nearest >= 0 && distanceSquared < threshold * threshold)
+        ? m_outputIndexKeys[nearest]
+        : AK_INVALID_AUDIO_OBJECT_ID;
+
     return (outClusterKey != AK_INVALID_AUDIO_OBJECT_ID) ? AK_Success : AK_Fail;
 }
 
-std::unordered_map<AkAudioObjectID, ClusterState> ObjectClusterFX::ReadClusterStates(const AkAudioObjects& inObjects)
+ObjectClusterFX::ClusterStateMap ObjectClusterFX::ReadClusterStates(const AkAudioObjects& inObjects)
 {
-    std::unordered_map<AkAudioObjectID, ClusterState> clusterStates;
+    ClusterStateMap clusterStates{ 0, ClusterStateMap::allocator_type(&m_frameArena) };
 
     for (AkUInt32 i = 0; i < inObjects.uNumObjects; ++i) {
         AkAudioObject* inObj = inObjects.ppObjects[i];
         AkAudioBuffer* inBuf = inObjects.ppObjectBuffers[i];
 
         auto it = m_mapInObjsToOutObjs.Exists(inObj->key);
-        if (it && it->isClustered) {
+        if (!it) continue;
+
+        if (it->isClustered) {
             AkAudioObjectID clusterID = it->outputObjKey;
             auto& state = clusterStates[clusterID];
 
@@ -540,6 +979,13 @@ std::unordered_map<AkAudioObjectID, ClusterState> ObjectClusterFX::ReadClusterSt
                 state.maxFrames = std::max(state.maxFrames, inBuf->uValidFrames);
             }
         }
+
+        // The output being faded out plays this buffer too, but doesn't wait for the input.
+        // This holds for an input that left its cluster to play on its own as well.
+        if (it->fadeOutputObjKey != AK_INVALID_AUDIO_OBJECT_ID && inBuf->uValidFrames > 0) {
+            auto& fadeState = clusterStates[it->fadeOutputObjKey];
+            fadeState.maxFrames = std::max(fadeState.maxFrames, inBuf->uValidFrames);
+        }
     }
 
     return clusterStates;
@@ -36,10 +36,15 @@ trademarks of CCP ehf.
 #include "ObjectClusterFXParams.h"
 #include <AK/Plugin/PluginServices/AkMixerInputMap.h>
 #include <set>
-#include <string>
 #include <unordered_map>
 #include "KMeans.h"
+#include "AgglomerativeClustering.h"
+#include "GridDensityClustering.h"
 #include "Utilities.h"
+#include "FrameArena.h"
+#include "KdTree.h"
+#include "AsyncClusterer.h"
+#include "ClusterTracker.h"
 
 /**
  * @struct GeneratedObject
@@ -50,6 +55,20 @@ struct GeneratedObject {
 	AkAudioObjectID outputObjKey;
 	int index;
 	bool isClustered = false;
+
+	// Motion estimate used to cluster on predicted positions
+	AkVector lastPosition{ 0, 0, 0 }; ///< Position in the previous frame
+	AkVector velocity{ 0, 0, 0 }; ///< Smoothed velocity in units per second
+	bool hasLastPosition = false;
+
+	// Persistent ID of the input's cluster, to count membership changes
+	AkUInt32 clusterId = 0;
+	bool hasCluster = false;
+
+	// Output the input migrated away from, faded out over the next buffer
+	AkAudioObjectID fadeOutputObjKey = AK_INVALID_AUDIO_OBJECT_ID;
+	AK::SpeakerVolumes::MatrixPtr fadeVolumeMatrix = nullptr;
+	bool fadeIsClustered = false; ///< Whether that output is a cluster's or the input's own
 };
 
 /**
@@ -69,6 +88,10 @@ struct ClusterState {
 class ObjectClusterFX : public AK::IAkOutOfPlaceObjectPlugin
 {
 public:
+    /// Per-output state gathered from the inputs each frame, allocated from the frame arena
+    using ClusterStateMap = std::unordered_map<AkAudioObjectID, ClusterState, std::hash<AkAudioObjectID>,
+        std::equal_to<AkAudioObjectID>, ArenaAllocator<std::pair<const AkAudioObjectID, ClusterState>>>;
+
     ObjectClusterFX();
     ~ObjectClusterFX();
 
@@ -109,16 +132,86 @@ public:
      */
     void Execute(const AkAudioObjects& inObjects, const AkAudioObjects& outObjects) override;
 
+    /**
+     * @brief Gets how often inputs changed cluster
+     * @details Also sent once a second as ObjectClusterMonitorData while the plugin is monitored
+     * @return Cluster changes per second, measured over the last full second of audio
+     */
+    AkReal32 GetMembershipChurn() const { return m_membershipChurn; }
+
 private:
     ObjectClusterFXParams* m_pParams;
     AK::IAkPluginMemAlloc* m_pAllocator;
     AK::IAkEffectPluginContext* m_pContext;
 
     /**
-     * @brief Updates KMeans algorithm with input object positions
+     * @brief Creates a clustering engine
+     * @param engineType Engine to create, a ClusteringEngineType value
+     * @return The new engine, K-means for unknown types
+     */
+    static std::unique_ptr<IClusteringEngine> CreateClusteringEngine(AkInt32 engineType);
+
+    /**
+     * @brief Gathers the engine settings from the parameters
+     * @return The settings to configure the engine with
+     */
+    ClusteringSettings GetClusteringSettings() const;
+
+    /**
+     * @brief Creates the clustering engine selected by the parameters, if it isn't the current one
+     */
+    void UpdateClusteringEngine();
+
+    /**
+     * @brief Starts or stops background clustering to follow the parameters
+     * @return True if clustering runs in the background
+     */
+    bool UpdateAsyncClustering();
+
+    /**
+     * @brief Runs the clustering engine on the input object positions
+     * @details With a clustering interval above one, the engine only runs every that many
+     * frames, or sooner when objects were added or removed or a setting changed; in between
+     * the cached clusters are kept and only their positions follow the members.
+     * With a prediction horizon, the engine gets each object's position extrapolated along
+     * its estimated velocity, while outputs stay at the mean of the members' real positions.
+     * In asynchronous mode the positions are handed to the shared worker pool and the
+     * newest result it finished is picked up instead, usually the previous frame's.
      * @param inObjects Input audio objects
+     * @return True if CurrentClusters() changed, so its clusters need matching to the tracked ones
+     */
+    bool FeedPositionsToEngine(const AkAudioObjects& inObjects);
+
+    /**
+     * @brief Updates an input's velocity estimate and extrapolates its position
+     * @param entry State of the input
+     * @param position Current position of the input
+     * @param frameSeconds Duration of a frame in seconds
+     * @param horizonSeconds How far ahead to extrapolate
+     * @return The position the input is expected at after the horizon
+     */
+    static AkVector PredictPosition(GeneratedObject& entry, const AkVector& position, float frameSeconds, float horizonSeconds);
+
+    /**
+     * @brief Checks whether the objects fed to the engine are the ones of the last clustering run
+     * @param positionsByKey This frame's objects, sorted by key
+     * @param keys Keys of the last run, sorted
+     * @return True if both hold the same keys
+     */
+    static bool SameKeys(const ArenaVector<ObjectPosition>& positionsByKey, const std::vector<AkAudioObjectID>& keys);
+
+    /**
+     * @brief Fills m_clusterCentroids for the clustering result used this frame
+     * @param positionsByKey This frame's objects sorted by key, to move each centroid to the mean
+     * of its members' current positions, or nullptr if the result comes from this frame's positions
      */
-    void FeedPositionsToKMeans(const AkAudioObjects& inObjects);
+    void UpdateClusterCentroids(const ArenaVector<ObjectPosition>* positionsByKey);
+
+    /**
+     * @brief Gets the clustering result used for this frame
+     * @return The result of the synchronous engine or the latest background one
+     */
+    const ClusterResult& CurrentClusters() const;
 
     /**
      * @brief Prepares audio objects for processing
@@ -149,18 +242,54 @@ private:
         GeneratedObject* userData,
         const ClusterState& clusterState);
 
+    /**
+     * @brief Fades an input out of the output it migrated away from
+     * @param inObj Input audio object
+     * @param inBuf Input audio buffer
+     * @param outBuf Buffer of the output being left
+     * @param userData Generated object data
+     * @param clusterState State of the output being left
+     */
+    void FadeOutOfCluster(
+        const AkAudioObject* inObj,
+        AkAudioBuffer* inBuf,
+        AkAudioBuffer* outBuf,
+        GeneratedObject* userData,
+        const ClusterState& clusterState);
+
+    /**
+     * @brief Fades an input out of the output of its own it migrated away from
+     * @param inBuf Input audio buffer
+     * @param outBuf Buffer of the output being left
+     */
+    void FadeOutOfUnclustered(
+        AkAudioBuffer* inBuf,
+        AkAudioBuffer* outBuf);
+
+    /**
+     * @brief Moves an input to another output
+     * @details The input fades in on the new output while it fades out of the old one
+     * over the next buffer, see FadeOutOfCluster and FadeOutOfUnclustered
+     * @param entry State of the input
+     * @param outputObjKey The output to move to
+     * @param isClustered Whether that output is a cluster's
+     */
+    void MigrateInput(GeneratedObject& entry, AkAudioObjectID outputObjKey, bool isClustered);
+
     /**
      * @brief Processes an unclustered audio object
      * @param inObj Input audio object
      * @param inBuf Input audio buffer
      * @param outObj Output audio object
      * @param outBuf Output audio buffer
+     * @param userData Generated object data
      */
     void ProcessUnclustered(
         const AkAudioObject* inObj,
         AkAudioBuffer* inBuf,
         AkAudioObject* outObj,
-        AkAudioBuffer* outBuf);
+        AkAudioBuffer* outBuf,
+        const GeneratedObject* userData);
 
     /**
      * @brief Mixes audio into a cluster
@@ -168,14 +297,14 @@ private:
      * @param inBuffer Input audio buffer
      * @param outBuffer Output audio buffer
      * @param cumulativeGain Cumulative gain ramp
-     * @param pGeneratedObject Generated object data
+     * @param volumeMatrix Volumes of the previous buffer for this input and output, allocated on first use
      */
     void MixToCluster(
         const AkAudioObject* inObject,
         AkAudioBuffer* inBuffer,
         AkAudioBuffer* outBuffer,
         const AkRamp& cumulativeGain,
-        GeneratedObject* pGeneratedObject);
+        AK::SpeakerVolumes::MatrixPtr& volumeMatrix);
 
     /**
      * @brief Gets current output objects
@@ -188,7 +317,13 @@ private:
      * @param inObjects Input audio objects
      * @return Map of cluster states
      */
-    std::unordered_map<AkAudioObjectID, ClusterState> ReadClusterStates(const AkAudioObjects& inObjects);
+    ClusterStateMap ReadClusterStates(const AkAudioObjects& inObjects);
+
+    /**
+     * @brief Indexes the existing outputs that clustered inputs are mixed into, for FindBestCluster
+     * @param existingOutputs Existing output objects
+     */
+    void BuildOutputIndex(const AkAudioObjects& existingOutputs);
 
     /**
      * @brief Finds the best cluster for a position
@@ -202,12 +337,19 @@ private:
         const AkAudioObjects& existingOutputs,
         AkAudioObjectID& outClusterKey);
 
+    /**
+     * @brief Records the cluster an input is in now and counts it if that changed
+     * @param entry State of the input
+     * @param cluster Index of the input's cluster in the clustering result, or -1
+     */
+    void TrackMembership(GeneratedObject& entry, int cluster);
+
     /**
      * @brief Gets the cluster containing an object
      * @param objectId Object identifier
-     * @return Pointer to cluster pair or nullptr if not found
+     * @return Index of the cluster in the clustering result or -1 if not found
      */
-    const std::pair<AkVector, std::vector<AkAudioObjectID>>* GetCluster(AkAudioObjectID objectId) const;
+    int GetClusterIndex(AkAudioObjectID objectId) const;
 
     /**
      * @brief Allocates volume matrix memory
@@ -229,20 +371,56 @@ private:
      */
     void FreeAllVolumes();
 
-	std::unique_ptr<KMeans> m_kmeans;
+	/// Initial size of the frame arena, it grows on its own if a frame needs more
+	static constexpr size_t kFrameArenaSize = 64 * 1024;
+
+	/// Objects the storage kept across frames is reserved for in Init; a busier bus grows it on the first frame it gets that busy
+	static constexpr AkUInt32 kReservedObjects = 1024;
+
+	/// Per-Execute scratch memory, reset at the top of every Execute
+	FrameArena m_frameArena;
+
+	std::unique_ptr<IClusteringEngine> m_engine; ///< Engine used when clustering on the audio thread
+	AkInt32 m_engineType = -1;
+	std::unique_ptr<AsyncClusterer> m_asyncClusterer; ///< Background clustering on the shared pool, joined in Init when needed
+	bool m_asyncUnavailable = false; ///< Set if the pool had no worker to offer, clustering stays synchronous
+	AkUInt32 m_sampleRate = 0; ///< Sample rate of the bus, to turn frame sizes into deadlines
+
+	/// State of the last clustering run, which is repeated only when due, see FeedPositionsToEngine
+	AkInt32 m_framesSinceClustering = 0;
+	bool m_clusteredAsync = false;
+	AkInt32 m_clusteredEngineType = -1;
+	ClusteringSettings m_clusteredSettings;
+	std::vector<AkAudioObjectID> m_clusteredKeys; ///< Sorted keys of the objects, only recorded while the interval is above one or clustering is asynchronous, reserved in Init
+
+	/// Persistent identity and output object of each cluster of CurrentClusters()
+	ClusterTracker m_clusterTracker;
+
+	/// Per cluster of CurrentClusters(): position of its output, the mean of its members' current positions
+	std::vector<AkVector> m_clusterCentroids;
+
+	/// Weight of the newest frame-to-frame velocity in the smoothed estimate
+	static constexpr float kVelocitySmoothing = 0.5f;
+
+	/// Membership churn, see GetMembershipChurn
+	AkUInt32 m_membershipChanges = 0; ///< Cluster changes counted since m_churnFrames was last reset
+	AkUInt32 m_churnFrames = 0;
+	AkReal32 m_membershipChurn = 0.0f;
+
 	std::unique_ptr<Utilities> m_utilities;
 	std::vector<AkAudioBuffer*> m_tempBuffers;
 	std::vector<AkAudioObject*> m_tempObjects;
 
-	float m_lastDistanceThreshold = -1.0f;
-
-	/// Maps that hold KMeans clustering data
-	std::vector<std::pair<AkVector, std::vector<AkAudioObjectID>>> m_clusters;
+	/// Positions of the clustered outputs, valid for the frame once m_outputIndexValid is set
+	KdTree m_outputIndex;
+	std::vector<AkAudioObjectID> m_outputIndexKeys;
+	std::vector<AkVector> m_outputIndexPositions;
+	bool m_outputIndexValid = false;
 
 	/// Maps input objects to their corresponding output objects and processing information
 	AkMixerInputMap<AkUInt64, GeneratedObject> m_mapInObjsToOutObjs;
 
-	void UpdateClusterPositions(const AkAudioObjects& inObjects);
+	void UpdateClusterPositions();
 };
 
 #endif // ObjectClusterFX_H
\ No newline at end of file
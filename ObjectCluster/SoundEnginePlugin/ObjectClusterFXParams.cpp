@@ -54,6 +54,18 @@ AKRESULT ObjectClusterFXParams::Init(AK::IAkPluginMemAlloc* in_pAllocator, const
     {
         // Initialize default parameters here
         RTPC.distanceThreshold = 200.f;
+        NonRTPC.warmStart = false;
+        NonRTPC.coresetSize = 0;
+        NonRTPC.miniBatchSize = 0;
+        NonRTPC.clusteringEngine = ClusteringEngine_KMeans;
+        NonRTPC.timeBudget = 0;
+        NonRTPC.asyncClustering = false;
+        NonRTPC.threadCount = 1;
+        NonRTPC.clusteringInterval = 1;
+        NonRTPC.movementEpsilon = 0.f;
+        NonRTPC.maxChangedPercent = 20;
+        NonRTPC.predictionHorizon = 0;
+        NonRTPC.hysteresisMargin = 0.f;
 
         m_paramChangeHandler.SetAllParamChanges();
         return AK_Success;
@@ -74,6 +86,18 @@ AKRESULT ObjectClusterFXParams::SetParamsBlock(const void* in_pParamsBlock, AkUI
     AkUInt8* pParamsBlock = (AkUInt8*)in_pParamsBlock;
 
     RTPC.distanceThreshold = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.warmStart = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.coresetSize = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.miniBatchSize = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.clusteringEngine = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.timeBudget = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.asyncClustering = READBANKDATA(bool, pParamsBlock, in_ulBlockSize);
+    NonRTPC.threadCount = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.clusteringInterval = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.movementEpsilon = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.maxChangedPercent = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.predictionHorizon = READBANKDATA(AkInt32, pParamsBlock, in_ulBlockSize);
+    NonRTPC.hysteresisMargin = READBANKDATA(AkReal32, pParamsBlock, in_ulBlockSize);
 
     CHECKBANKDATASIZE(in_ulBlockSize, eResult);
     m_paramChangeHandler.SetAllParamChanges();
@@ -92,6 +116,54 @@ AKRESULT ObjectClusterFXParams::SetParam(AkPluginParamID in_paramID, const void*
         RTPC.distanceThreshold = *((AkReal32*)in_pValue);
         m_paramChangeHandler.SetParamChange(DISTANCE_THRESHOLD);
         break;
+    case WARM_START:
+        NonRTPC.warmStart = *((bool*)in_pValue);
+        m_paramChangeHandler.SetParamChange(WARM_START);
+        break;
+    case CORESET_SIZE:
+        NonRTPC.coresetSize = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(CORESET_SIZE);
+        break;
+    case MINI_BATCH_SIZE:
+        NonRTPC.miniBatchSize = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(MINI_BATCH_SIZE);
+        break;
+    case CLUSTERING_ENGINE:
+        NonRTPC.clusteringEngine = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(CLUSTERING_ENGINE);
+        break;
+    case TIME_BUDGET:
+        NonRTPC.timeBudget = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(TIME_BUDGET);
+        break;
+    case ASYNC_CLUSTERING:
+        NonRTPC.asyncClustering = *((bool*)in_pValue);
+        m_paramChangeHandler.SetParamChange(ASYNC_CLUSTERING);
+        break;
+    case THREAD_COUNT:
+        NonRTPC.threadCount = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(THREAD_COUNT);
+        break;
+    case CLUSTERING_INTERVAL:
+        NonRTPC.clusteringInterval = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(CLUSTERING_INTERVAL);
+        break;
+    case MOVEMENT_EPSILON:
+        NonRTPC.movementEpsilon = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(MOVEMENT_EPSILON);
+        break;
+    case MAX_CHANGED_PERCENT:
+        NonRTPC.maxChangedPercent = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(MAX_CHANGED_PERCENT);
+        break;
+    case PREDICTION_HORIZON:
+        NonRTPC.predictionHorizon = *((AkInt32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(PREDICTION_HORIZON);
+        break;
+    case HYSTERESIS_MARGIN:
+        NonRTPC.hysteresisMargin = *((AkReal32*)in_pValue);
+        m_paramChangeHandler.SetParamChange(HYSTERESIS_MARGIN);
+        break;
     default:
         eResult = AK_InvalidParameter;
         break;
@@ -33,7 +33,33 @@ the specific language governing permissions and limitations under the License.
 // Add parameters IDs here, those IDs should map to the AudioEnginePropertyID
 // attributes in the xml property definition.
 static const AkPluginParamID DISTANCE_THRESHOLD = 0;
-static const AkUInt32 NUM_PARAMS = 1;
+static const AkPluginParamID WARM_START = 1;
+static const AkPluginParamID CORESET_SIZE = 2;
+static const AkPluginParamID MINI_BATCH_SIZE = 3;
+static const AkPluginParamID CLUSTERING_ENGINE = 4;
+static const AkPluginParamID TIME_BUDGET = 5;
+static const AkPluginParamID ASYNC_CLUSTERING = 6;
+static const AkPluginParamID THREAD_COUNT = 7;
+static const AkPluginParamID CLUSTERING_INTERVAL = 8;
+static const AkPluginParamID MOVEMENT_EPSILON = 9;
+static const AkPluginParamID MAX_CHANGED_PERCENT = 10;
+static const AkPluginParamID PREDICTION_HORIZON = 11;
+static const AkPluginParamID HYSTERESIS_MARGIN = 12;
+static const AkUInt32 NUM_PARAMS = 13;
+
+// Values of the CLUSTERING_ENGINE parameter
+enum ClusteringEngineType : AkInt32
+{
+    ClusteringEngine_KMeans = 0,
+    ClusteringEngine_Agglomerative = 1,
+    ClusteringEngine_GridDensity = 2
+};
+
+// Payload the sound engine plug-in sends with PostMonitorData once a second while monitored
+struct ObjectClusterMonitorData
+{
+    AkReal32 membershipChurn; ///< Cluster changes per second, see ObjectClusterFX::GetMembershipChurn
+};
 
 struct ObjectClusterRTPCParams
 {
@@ -42,6 +68,18 @@ struct ObjectClusterRTPCParams
 
 struct ObjectClusterNonRTPCParams
 {
+    bool warmStart;
+    AkInt32 coresetSize;
+    AkInt32 miniBatchSize;
+    AkInt32 clusteringEngine;
+    AkInt32 timeBudget;
+    bool asyncClustering;
+    AkInt32 threadCount;
+    AkInt32 clusteringInterval;
+    AkReal32 movementEpsilon;
+    AkInt32 maxChangedPercent;
+    AkInt32 predictionHorizon;
+    AkReal32 hysteresisMargin;
 };
 
 struct ObjectClusterFXParams
@@ -0,0 +1,59 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "PositionBuffer.h"
+
+void PositionBuffer::assign(const ObjectPosition* objects, AkUInt32 count)
+{
+    resize(count);
+
+    for (AkUInt32 i = 0; i < m_size; ++i) {
+        set(i, objects[i].position, objects[i].key);
+    }
+}
+
+void PositionBuffer::resize(AkUInt32 count)
+{
+    m_size = count;
+    const AkUInt32 padded = (m_size + kLaneWidth - 1) / kLaneWidth * kLaneWidth;
+
+    // resize() keeps the capacity, so steady-state frames do not reallocate
+    m_x.resize(padded);
+    m_y.resize(padded);
+    m_z.resize(padded);
+    m_keys.resize(m_size);
+
+    for (AkUInt32 i = m_size; i < padded; ++i) {
+        m_x[i] = 0.0f;
+        m_y[i] = 0.0f;
+        m_z[i] = 0.0f;
+    }
+}
+
+void PositionBuffer::clear()
+{
+    m_x.clear();
+    m_y.clear();
+    m_z.clear();
+    m_keys.clear();
+    m_size = 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <new>
+#include <cstddef>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/**
+ * @brief Represents a position and key for an audio object.
+ */
+struct ObjectPosition {
+    AkVector position; ///< The 3D position of the audio object.
+    AkAudioObjectID key; ///< The unique identifier of the audio object.
+};
+
+/**
+ * @brief Minimal STL allocator returning storage aligned to a fixed boundary.
+ * @tparam T The element type.
+ * @tparam Alignment The required alignment in bytes.
+ */
+template <typename T, std::size_t Alignment>
+struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U>
+    struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+    AlignedAllocator() = default;
+
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>&) {}
+
+    T* allocate(std::size_t count) {
+        return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t(Alignment)));
+    }
+
+    void deallocate(T* ptr, std::size_t) {
+        ::operator delete(ptr, std::align_val_t(Alignment));
+    }
+
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Alignment>&) const { return true; }
+
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Alignment>&) const { return false; }
+};
+
+/**
+ * @brief Structure-of-arrays store for object positions.
+ *
+ * Keeps the X, Y and Z coordinates in separate 32-byte aligned float lanes so the
+ * distance kernels can load eight objects per AVX register (four per SSE register)
+ * without gathering. Each lane is padded with zeros up to a multiple of kLaneWidth,
+ * so kernels never need a scalar tail loop; results computed for padding slots are
+ * simply ignored by the caller.
+ */
+class PositionBuffer {
+public:
+    static constexpr std::size_t kAlignment = 32; ///< Byte alignment of each lane.
+    static constexpr AkUInt32 kLaneWidth = 8; ///< Lane padding granularity, in elements.
+
+    using FloatLane = std::vector<float, AlignedAllocator<float, kAlignment>>;
+
+    /**
+     * @brief Copies a set of object positions into the SoA lanes.
+     * @param objects The objects to store.
+     * @param count The number of objects.
+     */
+    void assign(const ObjectPosition* objects, AkUInt32 count);
+
+    /**
+     * @brief Copies a set of object positions into the SoA lanes.
+     * @param objects The objects to store.
+     */
+    void assign(const std::vector<ObjectPosition>& objects) {
+        assign(objects.data(), static_cast<AkUInt32>(objects.size()));
+    }
+
+    /**
+     * @brief Resizes the buffer to the given object count, zeroing the padding.
+     *
+     * Existing entries are kept; new entries must be filled with set().
+     *
+     * @param count The new number of objects.
+     */
+    void resize(AkUInt32 count);
+
+    /**
+     * @brief Stores an object at the given index.
+     */
+    void set(AkUInt32 index, const AkVector& position, AkAudioObjectID key) {
+        m_x[index] = position.X;
+        m_y[index] = position.Y;
+        m_z[index] = position.Z;
+        m_keys[index] = key;
+    }
+
+    /**
+     * @brief Removes all positions while keeping the allocated capacity.
+     */
+    void clear();
+
+    /**
+     * @brief Gets the number of stored objects.
+     */
+    AkUInt32 size() const { return m_size; }
+
+    /**
+     * @brief Gets the lane length, which is size() rounded up to kLaneWidth.
+     */
+    AkUInt32 paddedSize() const { return static_cast<AkUInt32>(m_x.size()); }
+
+    bool empty() const { return m_size == 0; }
+
+    const float* x() const { return m_x.data(); }
+    const float* y() const { return m_y.data(); }
+    const float* z() const { return m_z.data(); }
+
+    /**
+     * @brief Gets the key of the object stored at the given index.
+     */
+    AkAudioObjectID key(AkUInt32 index) const { return m_keys[index]; }
+
+    /**
+     * @brief Reassembles the position of the object stored at the given index.
+     */
+    AkVector position(AkUInt32 index) const { return AkVector{ m_x[index], m_y[index], m_z[index] }; }
+
+private:
+    FloatLane m_x; ///< X coordinates.
+    FloatLane m_y; ///< Y coordinates.
+    FloatLane m_z; ///< Z coordinates.
+    std::vector<AkAudioObjectID> m_keys; ///< Object keys, not padded.
+    AkUInt32 m_size = 0; ///< Number of valid objects.
+};
@@ -0,0 +1,98 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "SpatialGrid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+    // Cell coordinates are clamped so far-away objects cannot overflow the integer range
+    constexpr float kMaxCellCoordinate = 1.0e9f;
+
+    AkInt32 toCellCoordinate(float value)
+    {
+        const float cell = std::floor(value);
+        return static_cast<AkInt32>(std::max(-kMaxCellCoordinate, std::min(kMaxCellCoordinate, cell)));
+    }
+}
+
+void SpatialGrid::build(const PositionBuffer& points, float cellSize)
+{
+    m_cellSize = cellSize;
+    m_invCellSize = 1.0f / cellSize;
+
+    const AkUInt32 numPoints = points.size();
+
+    // Power-of-two bucket count with at least two buckets per object keeps chains short
+    AkUInt32 numBuckets = 1;
+    while (numBuckets < numPoints * 2) {
+        numBuckets <<= 1;
+    }
+    m_bucketMask = numBuckets - 1;
+
+    m_bucketStart.assign(numBuckets + 1, 0);
+    m_entries.resize(numPoints);
+    m_entryCells.resize(numPoints);
+    m_pointCells.resize(numPoints);
+    m_pointBuckets.resize(numPoints);
+
+    // Count objects per bucket
+    for (AkUInt32 i = 0; i < numPoints; ++i) {
+        const Cell cell = cellOf(points.position(i));
+        const AkUInt32 bucket = bucketOf(cell);
+        m_pointCells[i] = cell;
+        m_pointBuckets[i] = bucket;
+        ++m_bucketStart[bucket + 1];
+    }
+
+    // Prefix sum turns counts into offsets
+    for (AkUInt32 b = 0; b < numBuckets; ++b) {
+        m_bucketStart[b + 1] += m_bucketStart[b];
+    }
+
+    // Scatter, using the start offsets as write cursors and restoring them afterwards
+    for (AkUInt32 i = 0; i < numPoints; ++i) {
+        const AkUInt32 slot = m_bucketStart[m_pointBuckets[i]]++;
+        m_entries[slot] = i;
+        m_entryCells[slot] = m_pointCells[i];
+    }
+    for (AkUInt32 b = numBuckets; b > 0; --b) {
+        m_bucketStart[b] = m_bucketStart[b - 1];
+    }
+    m_bucketStart[0] = 0;
+}
+
+SpatialGrid::Cell SpatialGrid::cellOf(const AkVector& position) const
+{
+    return Cell{
+        toCellCoordinate(position.X * m_invCellSize),
+        toCellCoordinate(position.Y * m_invCellSize),
+        toCellCoordinate(position.Z * m_invCellSize)
+    };
+}
+
+AkUInt32 SpatialGrid::hashCell(const Cell& cell)
+{
+    return (static_cast<AkUInt32>(cell.x) * 73856093u)
+        ^ (static_cast<AkUInt32>(cell.y) * 19349663u)
+        ^ (static_cast<AkUInt32>(cell.z) * 83492791u);
+}
@@ -0,0 +1,142 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+#include "PositionBuffer.h"
+
+/**
+ * @brief Uniform spatial hash grid over the objects of a PositionBuffer.
+ *
+ * Objects are bucketed by the integer cell containing them and stored in a
+ * compressed bucket array (counting sort), so a rebuild costs O(N) and keeps its
+ * allocations between frames. Several cells may share a bucket; the cell of each
+ * entry is stored alongside it so queries only ever report objects of the cells
+ * they asked for.
+ *
+ * With a cell size equal to the query radius, every object within that radius of
+ * a position lies in one of the 27 cells surrounding it.
+ */
+class SpatialGrid {
+public:
+    static constexpr AkUInt32 kNoObject = 0xFFFFFFFFu; ///< Returned by firstInCell() for an empty cell.
+
+    /**
+     * @brief Integer coordinates of a grid cell.
+     */
+    struct Cell {
+        AkInt32 x;
+        AkInt32 y;
+        AkInt32 z;
+
+        bool operator==(const Cell& other) const {
+            return x == other.x && y == other.y && z == other.z;
+        }
+    };
+
+    /**
+     * @brief Rebuilds the grid from a set of positions.
+     * @param points The positions to index.
+     * @param cellSize The edge length of a cell. Must be greater than zero.
+     */
+    void build(const PositionBuffer& points, float cellSize);
+
+    /**
+     * @brief Gets the cell containing a position.
+     */
+    Cell cellOf(const AkVector& position) const;
+
+    /**
+     * @brief Gets the cell of an indexed object, as computed by the last build().
+     */
+    const Cell& cellOfPoint(AkUInt32 index) const { return m_pointCells[index]; }
+
+    /**
+     * @brief Gets the lowest indexed object in a cell.
+     * @return The object index, or kNoObject if the cell is empty.
+     */
+    AkUInt32 firstInCell(const Cell& cell) const {
+        if (m_entries.empty()) return kNoObject;
+
+        // Entries of a bucket are in ascending object order, so the first match is the lowest
+        const AkUInt32 bucket = bucketOf(cell);
+        for (AkUInt32 e = m_bucketStart[bucket]; e < m_bucketStart[bucket + 1]; ++e) {
+            if (m_entryCells[e] == cell) {
+                return m_entries[e];
+            }
+        }
+        return kNoObject;
+    }
+
+    /**
+     * @brief Calls fn(index) for every indexed object in the given cell.
+     */
+    template <typename Fn>
+    void forEachInCell(const Cell& cell, Fn&& fn) const {
+        const AkUInt32 bucket = bucketOf(cell);
+        for (AkUInt32 e = m_bucketStart[bucket]; e < m_bucketStart[bucket + 1]; ++e) {
+            if (m_entryCells[e] == cell) {
+                fn(m_entries[e]);
+            }
+        }
+    }
+
+    /**
+     * @brief Calls fn(index) for every indexed object in the 27 cells around a position.
+     *
+     * The callback still has to test the actual distance; the grid only narrows
+     * the candidates down to the neighbouring cells.
+     */
+    template <typename Fn>
+    void forEachNeighbor(const AkVector& position, Fn&& fn) const {
+        if (m_entries.empty()) return;
+
+        const Cell center = cellOf(position);
+        for (AkInt32 dz = -1; dz <= 1; ++dz) {
+            for (AkInt32 dy = -1; dy <= 1; ++dy) {
+                for (AkInt32 dx = -1; dx <= 1; ++dx) {
+                    forEachInCell(Cell{ center.x + dx, center.y + dy, center.z + dz }, fn);
+                }
+            }
+        }
+    }
+
+    float cellSize() const { return m_cellSize; }
+
+    /**
+     * @brief Hashes a cell's coordinates; callers mask the result to their bucket count.
+     */
+    static AkUInt32 hashCell(const Cell& cell);
+
+private:
+    AkUInt32 bucketOf(const Cell& cell) const { return hashCell(cell) & m_bucketMask; }
+
+    float m_cellSize = 1.0f; ///< Edge length of a cell.
+    float m_invCellSize = 1.0f; ///< Reciprocal of the cell size.
+    AkUInt32 m_bucketMask = 0; ///< Bucket count minus one, the count is a power of two.
+    std::vector<AkUInt32> m_bucketStart; ///< Offset of each bucket in m_entries, plus one end offset.
+    std::vector<AkUInt32> m_entries; ///< Object indices grouped by bucket.
+    std::vector<Cell> m_entryCells; ///< Cell of each entry in m_entries.
+    std::vector<Cell> m_pointCells; ///< Scratch: cell of each object, by object index.
+    std::vector<AkUInt32> m_pointBuckets; ///< Scratch: bucket of each object, by object index.
+};
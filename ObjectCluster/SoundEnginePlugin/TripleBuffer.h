@@ -0,0 +1,101 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <atomic>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/**
+ * @brief Lock-free single-producer single-consumer exchange of the latest value.
+ *
+ * Three slots rotate between the producer, the consumer and a shared middle slot.
+ * The producer fills its slot and publish() swaps it with the middle one; the
+ * consumer's acquire() swaps its slot with the middle one if something new was
+ * published. Neither side ever waits for the other, and a slow consumer simply
+ * skips the values it didn't pick up in time. Slots are reused, so values with
+ * heap storage (vectors) stop allocating once they have reached their size.
+ *
+ * Only one thread may call writeBuffer()/publish(), and only one thread may call
+ * acquire()/readBuffer().
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    /**
+     * @brief Gets the producer's slot, to be filled before publish().
+     */
+    T& writeBuffer() { return m_slots[m_back]; }
+
+    /**
+     * @brief Hands the producer's slot over to the consumer side.
+     */
+    void publish() {
+        const AkUInt32 previous = m_middle.exchange(m_back | kFresh, std::memory_order_acq_rel);
+        m_back = previous & kIndexMask;
+    }
+
+    /**
+     * @brief Checks whether a value was published since the last acquire().
+     */
+    bool hasNew() const {
+        return (m_middle.load(std::memory_order_acquire) & kFresh) != 0;
+    }
+
+    /**
+     * @brief Takes the latest published value, if there is a new one.
+     * @return True if readBuffer() now holds a newer value.
+     */
+    bool acquire() {
+        if (!hasNew()) return false;
+
+        const AkUInt32 previous = m_middle.exchange(m_front, std::memory_order_acq_rel);
+        m_front = previous & kIndexMask;
+        return true;
+    }
+
+    /**
+     * @brief Gets the consumer's slot, the value taken by the last successful acquire().
+     */
+    T& readBuffer() { return m_slots[m_front]; }
+    const T& readBuffer() const { return m_slots[m_front]; }
+
+    /**
+     * @brief Calls fn(slot) for each of the three slots, for instance to reserve their storage.
+     *
+     * Only while neither side is using the buffer, such as before the first publish().
+     */
+    template <typename Fn>
+    void forEachSlot(Fn&& fn) {
+        for (T& slot : m_slots) {
+            fn(slot);
+        }
+    }
+
+private:
+    static constexpr AkUInt32 kIndexMask = 3; ///< Bits of m_middle holding the slot index.
+    static constexpr AkUInt32 kFresh = 4; ///< Set in m_middle while the middle slot holds an unread value.
+
+    T m_slots[3];
+    AkUInt32 m_back = 0; ///< Producer's slot.
+    std::atomic<AkUInt32> m_middle{ 1 }; ///< Shared slot, plus kFresh.
+    AkUInt32 m_front = 2; ///< Consumer's slot.
+};
@@ -53,6 +53,25 @@ void Utilities::CopyBuffer(AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer)
     }
 }
 
+void Utilities::MixBufferRamped(AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer, AkReal32 gainStart, AkReal32 gainEnd)
+{
+    const AkUInt32 frames = inBuffer->uValidFrames;
+    if (frames == 0) return;
+
+    const AkReal32 step = (gainEnd - gainStart) / frames;
+    for (AkUInt32 j = 0; j < inBuffer->NumChannels(); ++j)
+    {
+        const AkReal32* pInBuf = inBuffer->GetChannel(j);
+        AkReal32* outBuf = outBuffer->GetChannel(j);
+        AkReal32 gain = gainStart;
+        for (AkUInt32 k = 0; k < frames; ++k)
+        {
+            outBuf[k] += pInBuf[k] * gain;
+            gain += step;
+        }
+    }
+}
+
 AkAudioObjectID Utilities::CreateOutputObject(const AkAudioObject* inobj, const AkAudioObjects& inObjects, const AkUInt32 index, AK::IAkEffectPluginContext* m_pContext, const AkVector* clusterPosition)
 {
     AkAudioObjectID outputObjKey = AK_INVALID_AUDIO_OBJECT_ID;
@@ -84,7 +103,7 @@ AkAudioObjectID Utilities::CreateOutputObject(const AkAudioObject* inobj, const
     return outputObjKey;
 }
 
-float Utilities::GetDistanceSquared(const AkVector& v1, const AkVector& v2)
+float Utilities::GetDistanceSquared(const AkVector& v1, const AkVector& v2) const
 {
     float dx = v1.X - v2.X;
     float dy = v1.Y - v2.Y;
@@ -92,35 +111,4 @@ float Utilities::GetDistanceSquared(const AkVector& v1, const AkVector& v2)
     return dx * dx + dy * dy + dz * dz;
 }
 
-AkVector Utilities::CalculateMeanPosition(const std::vector<AkAudioObjectID>& clusterObjects, const AkAudioObjects& inObjects)
-{
-    AkVector sumPosition;
-    sumPosition.X = 0.0f;
-    sumPosition.Y = 0.0f;
-    sumPosition.Z = 0.0f;
-    int validObjectCount = 0;
-
-    // Sum up positions of all objects in the cluster
-    for (const auto& objId : clusterObjects) {
-        for (AkUInt32 i = 0; i < inObjects.uNumObjects; i++) {
-            if (inObjects.ppObjects[i]->key == objId) {
-                const AkVector& pos = inObjects.ppObjects[i]->positioning.threeD.xform.Position();
-                sumPosition.X += pos.X;
-                sumPosition.Y += pos.Y;
-                sumPosition.Z += pos.Z;
-                validObjectCount++;
-                break;
-            }
-        }
-    }
-
-    // Calculate mean position
-    if (validObjectCount > 0) {
-        sumPosition.X /= validObjectCount;
-        sumPosition.Y /= validObjectCount;
-        sumPosition.Z /= validObjectCount;
-    }
-    return sumPosition;
-}
-
 
@@ -59,6 +59,15 @@ public:
      */
     void CopyBuffer(AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer);
 
+    /**
+     * @brief Adds one audio buffer to another, under a gain ramping linearly over the buffer.
+     * @param inBuffer The input buffer.
+     * @param outBuffer The output buffer.
+     * @param gainStart Gain on the first frame.
+     * @param gainEnd Gain after the last frame.
+     */
+    void MixBufferRamped(AkAudioBuffer* inBuffer, AkAudioBuffer* outBuffer, AkReal32 gainStart, AkReal32 gainEnd);
+
     /**
      * @brief Creates an output audio object.
      * @param inobj The input audio object.
@@ -75,17 +84,6 @@ public:
       * @param v2 Second vector
       * @return The squared Euclidean distance between the vectors
       */
-    float GetDistanceSquared(const AkVector& v1, const AkVector& v2);
-
+    float GetDistanceSquared(const AkVector& v1, const AkVector& v2) const;
 
-    /**
-     * @brief Calculates the average position of a group of audio objects in a cluster.
-     *
-     * @param clusterObjects Vector of audio object IDs in the cluster
-     * @param inObjects Input audio objects containing position data
-     * @return AkVector The mean position of all objects in the cluster
-     */ 
-    AkVector CalculateMeanPosition(
-        const std::vector<AkAudioObjectID>& clusterObjects,
-        const AkAudioObjects& inObjects); 
 };
\ No newline at end of file
@@ -0,0 +1,363 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#include "WorkerPool.h"
+#include <algorithm>
+#include <system_error>
+
+std::shared_ptr<WorkerPool> WorkerPool::acquireShared()
+{
+    static std::mutex sharedMutex;
+    static std::weak_ptr<WorkerPool> shared;
+
+    std::lock_guard<std::mutex> lock(sharedMutex);
+    std::shared_ptr<WorkerPool> pool = shared.lock();
+    if (!pool) {
+        pool = std::make_shared<WorkerPool>();
+        shared = pool;
+    }
+    return pool;
+}
+
+WorkerPool::WorkerPool(unsigned int maxThreads)
+    : m_maxThreads(std::max(std::min(maxThreads, kMaxThreads), 1u))
+{
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        // Under the lock, so no worker adds threads after this
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopRequested.store(true, std::memory_order_release);
+    }
+    signal();
+
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+bool WorkerPool::reserveThreads(unsigned int numThreads)
+{
+    numThreads = std::min(numThreads, m_maxThreads);
+    if (threadCount() >= numThreads) return true;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return addWorkers(numThreads);
+}
+
+void WorkerPool::requestThreads(unsigned int numThreads)
+{
+    numThreads = std::min(numThreads, m_maxThreads);
+    if (threadCount() >= numThreads) return;
+
+    unsigned int requested = m_requestedThreads.load(std::memory_order_relaxed);
+    while (requested < numThreads) {
+        if (m_requestedThreads.compare_exchange_weak(requested, numThreads, std::memory_order_relaxed)) {
+            signal();
+            return;
+        }
+    }
+}
+
+bool WorkerPool::addWorkers(unsigned int numThreads)
+{
+    try {
+        while (m_workers.size() + 1 < numThreads) {
+            m_workers.emplace_back(&WorkerPool::workerLoop, this, static_cast<unsigned int>(m_workers.size()) + 1);
+            m_numWorkers.store(static_cast<unsigned int>(m_workers.size()), std::memory_order_release);
+        }
+    }
+    catch (const std::system_error&) {
+        return false;
+    }
+    return true;
+}
+
+void WorkerPool::run(AkUInt32 numTasks, TaskFunction task, void* context, unsigned int maxThreads, Clock::time_point deadline)
+{
+    if (numTasks == 0) return;
+
+    const AkUInt32 participants = std::min(std::min(maxThreads, threadCount()), numTasks);
+    BatchSlot* slot = nullptr;
+    if (participants > 1) {
+        for (BatchSlot& candidate : m_batchSlots) {
+            bool expected = false;
+            if (!candidate.claimed.load(std::memory_order_relaxed)
+                && candidate.claimed.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                slot = &candidate;
+                break;
+            }
+        }
+    }
+
+    // Nobody to share with, or every slot is taken
+    if (!slot) {
+        for (AkUInt32 t = 0; t < numTasks; ++t) {
+            task(context, t);
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.task = task;
+    batch.context = context;
+    batch.numTasks = numTasks;
+    batch.participants = participants;
+    batch.deadline = deadline;
+
+    // Contiguous ranges keep neighbouring tasks, and the memory they touch, on the same thread
+    for (AkUInt32 p = 0; p < participants; ++p) {
+        const AkUInt32 begin = static_cast<AkUInt32>(static_cast<AkUInt64>(numTasks) * p / participants);
+        const AkUInt32 end = static_cast<AkUInt32>(static_cast<AkUInt64>(numTasks) * (p + 1) / participants);
+        batch.ranges[p].range.store(packRange(begin, end), std::memory_order_relaxed);
+    }
+
+    slot->batch.store(&batch, std::memory_order_seq_cst);
+    signal();
+
+    AkUInt32 index;
+    AkUInt32 done = 0;
+    while (takeTask(batch, 0, index)) {
+        task(context, index);
+        ++done;
+    }
+    batch.completed.fetch_add(done, std::memory_order_acq_rel);
+
+    // Only tasks workers already started are left, at most one per worker, and no lock is
+    // held: they are short, so spin rather than sleep
+    while (batch.completed.load(std::memory_order_acquire) != numTasks) {
+        std::this_thread::yield();
+    }
+
+    // A worker that pinned the slot before the withdrawal may still be looking at the batch
+    slot->batch.store(nullptr, std::memory_order_seq_cst);
+    while (slot->pins.load(std::memory_order_seq_cst) != 0) {
+        std::this_thread::yield();
+    }
+    slot->claimed.store(false, std::memory_order_release);
+}
+
+void WorkerPool::signal()
+{
+    m_signal.fetch_add(1, std::memory_order_seq_cst);
+
+    // A worker counted as a sleeper checks m_signal before it waits, so either it sees the
+    // increment or it is waiting by the time the lock is free. Without sleepers there is
+    // nobody to wake and the lock is skipped.
+    if (m_sleepers.load(std::memory_order_seq_cst) != 0) {
+        { std::lock_guard<std::mutex> lock(m_sleepMutex); }
+        m_sleep.notify_all();
+    }
+}
+
+void WorkerPool::sleepUntilSignalled(AkUInt32 seenSignal)
+{
+    std::unique_lock<std::mutex> lock(m_sleepMutex);
+    m_sleepers.fetch_add(1, std::memory_order_seq_cst);
+    m_sleep.wait(lock, [&] { return m_signal.load(std::memory_order_seq_cst) != seenSignal; });
+    m_sleepers.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void WorkerPool::attach(PostedTask& task)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    task.m_detachRequested.store(false, std::memory_order_relaxed);
+    if (!task.m_attached) {
+        m_attached.push_back(&task);
+        task.m_attached = true;
+    }
+}
+
+void WorkerPool::detach(PostedTask& task)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (task.m_attached) {
+        m_attached.erase(std::find(m_attached.begin(), m_attached.end(), &task));
+        task.m_attached = false;
+    }
+    task.m_requested.store(false, std::memory_order_relaxed);
+    m_finished.wait(lock, [&] { return !task.m_running; });
+}
+
+void WorkerPool::post(PostedTask& task, Clock::time_point deadline)
+{
+    task.m_deadline.store(deadline.time_since_epoch().count(), std::memory_order_relaxed);
+    // Release, so the worker that takes the request sees what was written before posting
+    task.m_requested.store(true, std::memory_order_release);
+    signal();
+}
+
+void WorkerPool::withdraw(PostedTask& task)
+{
+    task.m_requested.store(false, std::memory_order_relaxed);
+}
+
+void WorkerPool::requestDetach(PostedTask& task)
+{
+    task.m_requested.store(false, std::memory_order_relaxed);
+    task.m_detachRequested.store(true, std::memory_order_relaxed);
+    signal();
+}
+
+bool WorkerPool::takeTask(Batch& batch, unsigned int participant, AkUInt32& outTask)
+{
+    for (unsigned int offset = 0; offset < batch.participants; ++offset) {
+        std::atomic<AkUInt64>& range = batch.ranges[(participant + offset) % batch.participants].range;
+        const bool own = offset == 0;
+
+        AkUInt64 current = range.load(std::memory_order_acquire);
+        for (;;) {
+            const AkUInt32 begin = static_cast<AkUInt32>(current >> 32);
+            const AkUInt32 end = static_cast<AkUInt32>(current);
+            if (begin >= end) break;
+
+            // The owner works from the front, thieves from the back
+            const AkUInt64 next = own ? packRange(begin + 1, end) : packRange(begin, end - 1);
+            if (range.compare_exchange_weak(current, next, std::memory_order_acq_rel)) {
+                outTask = own ? begin : end - 1;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool WorkerPool::helpBatch(unsigned int worker, size_t& nextSlot)
+{
+    BatchSlot* bestSlot = nullptr;
+    Batch* best = nullptr;
+    size_t bestPosition = 0;
+
+    // Earliest deadline first; starting after the last pick makes ties go round-robin. The
+    // best batch so far stays pinned, the others are unpinned as soon as they are looked at.
+    for (size_t k = 0; k < kMaxBatches; ++k) {
+        const size_t position = (nextSlot + k) % kMaxBatches;
+        BatchSlot& slot = m_batchSlots[position];
+        if (!slot.batch.load(std::memory_order_relaxed)) continue;
+
+        slot.pins.fetch_add(1, std::memory_order_seq_cst);
+        Batch* batch = slot.batch.load(std::memory_order_seq_cst);
+        if (batch && worker < batch->participants && !batch->exhausted.load(std::memory_order_relaxed)
+            && (!best || batch->deadline < best->deadline)) {
+            if (bestSlot) {
+                bestSlot->pins.fetch_sub(1, std::memory_order_release);
+            }
+            bestSlot = &slot;
+            best = batch;
+            bestPosition = position;
+        }
+        else {
+            slot.pins.fetch_sub(1, std::memory_order_release);
+        }
+    }
+    if (!best) return false;
+
+    nextSlot = bestPosition + 1;
+
+    // One task at a time, so the other batches get their turn
+    AkUInt32 index;
+    const bool took = takeTask(*best, worker, index);
+    if (!took) {
+        best->exhausted.store(true, std::memory_order_relaxed);
+    }
+    const TaskFunction task = best->task;
+    void* const context = best->context;
+    bestSlot->pins.fetch_sub(1, std::memory_order_release);
+
+    // The caller waits for this task before leaving run(), so the batch outlives the unpinning
+    if (took) {
+        task(context, index);
+        best->completed.fetch_add(1, std::memory_order_acq_rel);
+    }
+    return true;
+}
+
+WorkerPool::PostedTask* WorkerPool::pickPosted()
+{
+    // A running task is unregistered once it finished, by the worker that looks next
+    const auto detached = [](PostedTask* task) {
+        if (task->m_running || !task->m_detachRequested.load(std::memory_order_relaxed)) return false;
+        task->m_attached = false;
+        return true;
+    };
+    m_attached.erase(std::remove_if(m_attached.begin(), m_attached.end(), detached), m_attached.end());
+
+    PostedTask* best = nullptr;
+    Clock::rep bestDeadline = 0;
+    for (PostedTask* task : m_attached) {
+        // A task posted again while it runs waits for that run to finish
+        if (task->m_running || !task->m_requested.load(std::memory_order_relaxed)) continue;
+
+        const Clock::rep deadline = task->m_deadline.load(std::memory_order_relaxed);
+        if (!best || deadline < bestDeadline) {
+            best = task;
+            bestDeadline = deadline;
+        }
+    }
+
+    // A withdraw() since the check leaves nothing to run
+    if (!best || !best->m_requested.exchange(false, std::memory_order_acquire)) return nullptr;
+
+    best->m_running = true;
+    return best;
+}
+
+void WorkerPool::workerLoop(unsigned int worker)
+{
+    size_t nextSlot = 0;
+    for (;;) {
+        // Read before looking for work, so anything published after the look changes it
+        const AkUInt32 seenSignal = m_signal.load(std::memory_order_seq_cst);
+        if (m_stopRequested.load(std::memory_order_acquire)) return;
+
+        // A failed thread creation is only retried once threads are requested again
+        const unsigned int requested = m_requestedThreads.exchange(0, std::memory_order_relaxed);
+        if (requested > threadCount()) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_stopRequested.load(std::memory_order_relaxed)) {
+                addWorkers(requested);
+            }
+        }
+
+        // Loops come first, their callers are waiting on them
+        if (helpBatch(worker, nextSlot)) continue;
+
+        PostedTask* posted = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            posted = pickPosted();
+        }
+        if (posted) {
+            posted->m_task(posted->m_context, 0);
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                posted->m_running = false;
+            }
+            m_finished.notify_all();
+            continue;
+        }
+
+        sleepUntilSignalled(seenSignal);
+    }
+}
@@ -0,0 +1,290 @@
+/*
+ * Copyright 2024 CCP ehf.
+ *
+ * This software was developed by CCP Games for spatial audio object clustering
+ * in EVE Online and EVE Frontier.
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ * This license does not grant any rights to CCP's trademarks or game content.
+ * EVE Online and EVE Frontier are registered trademarks of CCP ehf.
+ */
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <AK/SoundEngine/Common/AkTypes.h>
+
+/**
+ * @brief Persistent thread pool shared by every clustering instance in the process.
+ *
+ * The pool takes two kinds of work:
+ * - Parallel loops, through run(). The caller takes part in its own loop and returns
+ *   once all of its tasks are done. The tasks are split into one contiguous range per
+ *   participant. A participant takes tasks from the front of its own range and, once
+ *   that is empty, steals from the back of the others.
+ * - Background tasks, through post(), such as the clustering job of an instance
+ *   clustering asynchronously. They run on a worker while no loop needs help.
+ *
+ * Workers pick the work with the earliest deadline. Work with equal deadlines, or
+ * none, is served in turn: loops round-robin one task at a time, background tasks in
+ * the order they were attached. Each instance has at most one loop and one background
+ * task in the pool at a time, so every instance gets its share whatever the others submit.
+ *
+ * run() is called on the audio thread, so it never takes the pool lock and never
+ * allocates: a loop is published in one of kMaxBatches fixed slots, and the caller
+ * works through its own tasks and steals from the others before waiting for the ones
+ * workers have already started. Workers pin a slot while they look at its loop, and
+ * the caller waits for the pins to drop before its loop goes out of scope. With every
+ * slot taken, the caller runs the loop on its own. Idle workers sleep on a lock of
+ * their own that run() only touches when a worker is actually asleep, for as long as
+ * it takes that worker to start waiting.
+ *
+ * Posting a background task only sets atomics and signals the workers the same way, so
+ * the audio thread can post every frame without taking the pool lock. Idle workers
+ * sleep until signalled, so a pool nobody uses costs no wakeups.
+ *
+ * The pool grows to the largest thread count asked of it and never past kMaxThreads,
+ * however many instances share it. reserveThreads() creates the threads on the spot and
+ * is meant for initialization; requestThreads() can be called from the audio thread and
+ * signals a worker to create them. Which thread runs a task is not deterministic:
+ * loop tasks should write their output to a slot of their own and let the caller
+ * combine the slots in task order.
+ */
+class WorkerPool {
+public:
+    /// Runs one task; context is the pointer given with the task
+    using TaskFunction = void (*)(void* context, AkUInt32 task);
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr unsigned int kMaxThreads = 16; ///< Most threads running tasks, including the callers of run().
+    static constexpr unsigned int kMaxBatches = 32; ///< Most run() calls sharing the workers at once; more run on their caller alone.
+
+    /**
+     * @brief Background task, owned by the code posting it.
+     *
+     * A task is attached to the pool once, then posted any number of times. Posting it
+     * again before it starts only updates its deadline, and posting it while it runs
+     * requests one more run.
+     */
+    class PostedTask {
+    public:
+        PostedTask(TaskFunction task, void* context) : m_task(task), m_context(context) {}
+
+    private:
+        friend class WorkerPool;
+        TaskFunction m_task;
+        void* m_context;
+        std::atomic<Clock::rep> m_deadline{ Clock::time_point::max().time_since_epoch().count() };
+        std::atomic<bool> m_requested{ false }; ///< Set by post(), cleared when a worker starts the run.
+        std::atomic<bool> m_detachRequested{ false }; ///< Set by requestDetach(), cleared by attach().
+        bool m_attached = false; ///< Guarded by the pool mutex.
+        bool m_running = false; ///< Guarded by the pool mutex.
+    };
+
+    /**
+     * @brief Gets the pool shared by the process, creating it on first use.
+     *
+     * The pool lives as long as someone holds a reference, and is stopped when the
+     * last one is released.
+     */
+    static std::shared_ptr<WorkerPool> acquireShared();
+
+    /**
+     * @param maxThreads Most threads the pool may grow to, including the callers of run(); capped to kMaxThreads.
+     */
+    explicit WorkerPool(unsigned int maxThreads = kMaxThreads);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * @brief Grows the pool so a run() call can use numThreads threads.
+     * @param numThreads Threads wanted, including the caller of run(); capped to the pool's maximum.
+     * @return False if a thread could not be created; the pool keeps the ones it has.
+     */
+    bool reserveThreads(unsigned int numThreads);
+
+    /**
+     * @brief Asks for the pool to grow so a run() call can use numThreads threads. Lock-free, never waits.
+     *
+     * The threads are created by a worker, so a pool without any only grows through reserveThreads().
+     * Until then run() uses the threads there are.
+     * @param numThreads Threads wanted, including the caller of run(); capped to the pool's maximum.
+     */
+    void requestThreads(unsigned int numThreads);
+
+    /**
+     * @brief Gets the number of threads a run() call can use, including the caller.
+     */
+    unsigned int threadCount() const { return m_numWorkers.load(std::memory_order_acquire) + 1; }
+
+    /**
+     * @brief Runs tasks 0 .. numTasks - 1 and waits for all of them.
+     * @param numTasks The number of tasks.
+     * @param task The task function.
+     * @param context Passed to every call of the task function.
+     * @param maxThreads Most threads working on the tasks, including the caller.
+     * @param deadline Time the caller needs the tasks done by, used to order the work.
+     */
+    void run(AkUInt32 numTasks, TaskFunction task, void* context,
+        unsigned int maxThreads = kMaxThreads, Clock::time_point deadline = Clock::time_point::max());
+
+    /**
+     * @brief Runs fn(task) for tasks 0 .. numTasks - 1 and waits for all of them.
+     */
+    template <typename Fn>
+    void parallelFor(AkUInt32 numTasks, Fn& fn,
+        unsigned int maxThreads = kMaxThreads, Clock::time_point deadline = Clock::time_point::max()) {
+        run(numTasks, [](void* context, AkUInt32 task) { (*static_cast<Fn*>(context))(task); }, &fn,
+            maxThreads, deadline);
+    }
+
+    /**
+     * @brief Registers a background task with the pool, so workers look for it when it is posted.
+     *
+     * Attaching a task again, or one whose detach was requested, only cancels the request.
+     * @param task The task, which must stay alive until detach() returns.
+     */
+    void attach(PostedTask& task);
+
+    /**
+     * @brief Unregisters a background task, waiting for it to finish if it is running.
+     */
+    void detach(PostedTask& task);
+
+    /**
+     * @brief Drops the pending run of a background task and leaves it to a worker to unregister it. Lock-free, never waits.
+     *
+     * The task must still stay alive until detach() returns.
+     */
+    void requestDetach(PostedTask& task);
+
+    /**
+     * @brief Requests a run of an attached background task. Lock-free, never waits.
+     * @param task The attached task.
+     * @param deadline Time the task should be done by, used to order the work.
+     */
+    void post(PostedTask& task, Clock::time_point deadline);
+
+    /**
+     * @brief Drops the pending run of a background task, if it has not started. Lock-free, never waits.
+     *
+     * A run already in progress finishes in the background.
+     */
+    void withdraw(PostedTask& task);
+
+private:
+    /**
+     * @brief Remaining task range of one participant, begin in the high half and end in the low half.
+     *
+     * Padded to a cache line so participants don't slow down each other's updates.
+     */
+    struct alignas(64) TaskRange {
+        std::atomic<AkUInt64> range{ 0 };
+    };
+
+    /**
+     * @brief State of one run() call, on the caller's stack.
+     */
+    struct Batch {
+        TaskFunction task = nullptr;
+        void* context = nullptr;
+        AkUInt32 numTasks = 0;
+        AkUInt32 participants = 0; ///< Threads allowed on the batch; worker n takes part if n < participants.
+        Clock::time_point deadline;
+        TaskRange ranges[kMaxThreads]; ///< Per participant; the caller is participant 0.
+        std::atomic<AkUInt32> completed{ 0 }; ///< Tasks finished, by any thread.
+        std::atomic<bool> exhausted{ false }; ///< Set once a worker found no task left to take.
+    };
+
+    /**
+     * @brief Place where a run() call publishes its batch to the workers.
+     *
+     * A worker pins the slot before loading the batch and unpins it once it took a task,
+     * so the caller knows when no worker can still touch a batch it withdrew.
+     */
+    struct alignas(64) BatchSlot {
+        std::atomic<bool> claimed{ false }; ///< Owned by a run() call, from publishing until the pins dropped.
+        std::atomic<Batch*> batch{ nullptr }; ///< The published batch, null once withdrawn.
+        std::atomic<AkUInt32> pins{ 0 }; ///< Workers looking at the batch.
+    };
+
+    static AkUInt64 packRange(AkUInt32 begin, AkUInt32 end) {
+        return (static_cast<AkUInt64>(begin) << 32) | end;
+    }
+
+    /**
+     * @brief Takes a task of a batch: the first of the participant's own range, else the last of another's.
+     */
+    static bool takeTask(Batch& batch, unsigned int participant, AkUInt32& outTask);
+
+    /**
+     * @brief Creates workers until the pool has numThreads threads. Called with m_mutex held.
+     * @return False if a thread could not be created.
+     */
+    bool addWorkers(unsigned int numThreads);
+
+    /**
+     * @brief Runs one task of the batch with the earliest deadline the worker can help with.
+     * @param worker Index of the worker, from 1.
+     * @param nextSlot Slot to start looking from, so ties go round-robin; updated past the slot picked.
+     * @return False if there was no batch to help with.
+     */
+    bool helpBatch(unsigned int worker, size_t& nextSlot);
+
+    /**
+     * @brief Wakes the sleeping workers, if any. Never waits longer than it takes a worker to start waiting.
+     */
+    void signal();
+
+    /**
+     * @brief Sleeps until signal() is called, unless it was called since the worker read seenSignal.
+     */
+    void sleepUntilSignalled(AkUInt32 seenSignal);
+
+    /**
+     * @brief Picks the posted background task to run next, or nullptr, unregistering the
+     * ones whose detach was requested on the way. Called with m_mutex held.
+     */
+    PostedTask* pickPosted();
+
+    /**
+     * @brief Worker loop: helps with batches and runs background tasks until the pool is destroyed.
+     * @param worker Index of the worker, from 1.
+     */
+    void workerLoop(unsigned int worker);
+
+    const unsigned int m_maxThreads; ///< Most threads including the callers of run(), at most kMaxThreads.
+    std::vector<std::thread> m_workers; ///< Guarded by m_mutex.
+    std::atomic<unsigned int> m_numWorkers{ 0 };
+    std::atomic<unsigned int> m_requestedThreads{ 1 }; ///< Largest requestThreads() count, for the workers to act on.
+
+    BatchSlot m_batchSlots[kMaxBatches]; ///< Published run() calls.
+
+    std::mutex m_sleepMutex; ///< Only held by workers going to sleep, and by signal() while one is.
+    std::condition_variable m_sleep; ///< Wakes sleeping workers for new loops, posts, thread requests and stopping.
+    std::atomic<AkUInt32> m_signal{ 0 }; ///< Incremented by every signal().
+    std::atomic<unsigned int> m_sleepers{ 0 }; ///< Workers in sleepUntilSignalled().
+
+    std::mutex m_mutex; ///< Guards the workers and the background tasks; never taken by run().
+    std::condition_variable m_finished; ///< Signals finished background tasks.
+    std::vector<PostedTask*> m_attached; ///< Background tasks in attaching order.
+    std::atomic<bool> m_stopRequested{ false }; ///< Set by the destructor, under m_mutex.
+};
@@ -39,10 +39,20 @@ ObjectClusterPlugin::~ObjectClusterPlugin()
 bool ObjectClusterPlugin::GetBankParameters(const GUID & in_guidPlatform, AK::Wwise::Plugin::DataWriter& in_dataWriter) const
 {
     // Write bank data here
-    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CCP:tolerance"));
+    // The order must match ObjectClusterFXParams::SetParamsBlock
     in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CCP:distanceThreshold"));
-    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "CCP:useKmeansClustering"));
-    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "CCP:useCustomDSP"));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "CCP:warmStart"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:coresetSize"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:miniBatchSize"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:clusteringEngine"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:timeBudget"));
+    in_dataWriter.WriteBool(m_propertySet.GetBool(in_guidPlatform, "CCP:asyncClustering"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:threadCount"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:clusteringInterval"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CCP:movementEpsilon"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:maxChangedPercent"));
+    in_dataWriter.WriteInt32(m_propertySet.GetInt32(in_guidPlatform, "CCP:predictionHorizon"));
+    in_dataWriter.WriteReal32(m_propertySet.GetReal32(in_guidPlatform, "CCP:hysteresisMargin"));
 
     return true;
 }